@@ -0,0 +1,392 @@
+#include "AnalyticsStore.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char file_magic[8] = {'R', 'W', 'S', 'T', 'A', 'T', '1', '\n'};
+const char chunk_magic[4] = {'C', 'H', 'N', 'K'};
+constexpr uint32_t max_columns = 256;
+
+// Chunk layout: this header, then column_count {bytes, checksum} entries,
+// then the columns back to back. payload_bytes covers the entries and columns.
+struct ChunkHeader {
+    char magic[4];
+    uint32_t rows;
+    uint32_t column_count;
+    uint32_t payload_bytes;
+};
+static_assert(sizeof(ChunkHeader) == 16, "chunk header is 16 bytes");
+
+struct ColumnEntry {
+    uint32_t bytes;
+    uint32_t checksum;
+};
+
+const char* column_names[analytics_column_count] = {
+    "match", "seed", "rounds", "robot", "result", "health", "armor",
+    "shots_flamethrower", "shots_railgun", "shots_grenade", "shots_hammer", "hits",
+    "damage_dealt", "damage_taken", "pit_falls", "flame_burns", "rounds_survived", "distance_moved",
+};
+
+// FNV-1a, 32 bit
+uint32_t checksum(const unsigned char* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool get_varint(const unsigned char*& in, const unsigned char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; in < end && shift < 64; shift += 7) {
+        unsigned char byte = *in++;
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// Each value as the zigzagged difference from the one before; a difference
+// of 0 is followed by how many more repeats come after it.
+void encode_column(const std::vector<int64_t>& values, std::string& out) {
+    int64_t previous = 0;
+    for (size_t i = 0; i < values.size();) {
+        int64_t delta = values[i] - previous;
+        if (delta == 0) {
+            size_t run = 1;
+            while (i + run < values.size() && values[i + run] == previous) run++;
+            put_varint(out, 0);
+            put_varint(out, run - 1);
+            i += run;
+        } else {
+            put_varint(out, (uint64_t(delta) << 1) ^ uint64_t(delta >> 63));
+            previous = values[i++];
+        }
+    }
+}
+
+bool decode_column(const unsigned char* in, const unsigned char* end, size_t rows, std::vector<int64_t>& values) {
+    values.clear();
+    values.reserve(rows);
+    int64_t previous = 0;
+    while (values.size() < rows) {
+        uint64_t code;
+        if (!get_varint(in, end, code)) return false;
+        if (code == 0) {
+            uint64_t more;
+            if (!get_varint(in, end, more) || more >= rows - values.size()) return false;
+            values.insert(values.end(), more + 1, previous);
+        } else {
+            previous += static_cast<int64_t>((code >> 1) ^ (~(code & 1) + 1));
+            values.push_back(previous);
+        }
+    }
+    return in == end;
+}
+
+bool read_at(int fd, void* data, size_t size, uint64_t offset) {
+    char* out = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t n = pread(fd, out, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        out += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+} // namespace
+
+const char* analytics_column_name(int column) { return column_names[column]; }
+
+int analytics_column(const std::string& name) {
+    for (int c = 0; c < analytics_column_count; c++) {
+        if (name == column_names[c]) return c;
+    }
+    return -1;
+}
+
+// ---------------------------------------------------------------- writer
+
+AnalyticsWriter::AnalyticsWriter(const std::string& path, size_t chunk_rows)
+    : path(path), chunk_rows(std::max<size_t>(chunk_rows, 1)) {}
+
+AnalyticsWriter::~AnalyticsWriter() { flush(); }
+
+void AnalyticsWriter::append(uint64_t match, uint32_t seed, const MatchResult& result) {
+    for (const auto& robot : result.robots) {
+        size_t code = std::find(names.begin(), names.end(), robot.name) - names.begin();
+        if (code == names.size()) names.push_back(robot.name);
+
+        int outcome = 0;
+        if (!result.winner.empty()) outcome = robot.name == result.winner ? 1 : -1;
+        else if (result.outcome == "no_survivors") outcome = -1;
+
+        const MatchResult::RobotStats& stats = robot.stats;
+        int64_t row[analytics_column_count] = {
+            static_cast<int64_t>(match), seed, result.rounds, static_cast<int64_t>(code), outcome,
+            robot.health, robot.armor,
+            stats.shots[0], stats.shots[1], stats.shots[2], stats.shots[3], stats.hits,
+            stats.damage_dealt, stats.damage_taken, stats.pit_falls, stats.flame_burns,
+            stats.rounds_survived, stats.distance_moved,
+        };
+        for (int c = 0; c < analytics_column_count; c++) columns[c].push_back(row[c]);
+        if (++rows >= chunk_rows) flush();
+    }
+}
+
+bool AnalyticsWriter::flush() {
+    if (rows == 0) return true;
+
+    // The robot column leads with its dictionary
+    std::string encoded[analytics_column_count];
+    put_varint(encoded[col_robot], names.size());
+    for (const auto& name : names) {
+        put_varint(encoded[col_robot], name.size());
+        encoded[col_robot] += name;
+    }
+    for (int c = 0; c < analytics_column_count; c++) encode_column(columns[c], encoded[c]);
+
+    ChunkHeader header;
+    std::memcpy(header.magic, chunk_magic, sizeof(chunk_magic));
+    header.rows = static_cast<uint32_t>(rows);
+    header.column_count = analytics_column_count;
+    header.payload_bytes = analytics_column_count * sizeof(ColumnEntry);
+    std::string chunk(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& column : encoded) {
+        ColumnEntry entry = {static_cast<uint32_t>(column.size()),
+                             checksum(reinterpret_cast<const unsigned char*>(column.data()), column.size())};
+        chunk.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        header.payload_bytes += entry.bytes;
+    }
+    std::memcpy(chunk.data() + offsetof(ChunkHeader, payload_bytes), &header.payload_bytes, sizeof(uint32_t));
+    for (const auto& column : encoded) chunk += column;
+
+    rows = 0;
+    for (auto& column : columns) column.clear();
+    names.clear();
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "Could not open analytics file " << path << ": " << strerror(errno) << "\n";
+        return false;
+    }
+    flock(fd, LOCK_EX);
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size == 0) chunk.insert(0, file_magic, sizeof(file_magic));
+    size_t written = 0;
+    while (written < chunk.size()) {
+        ssize_t n = ::write(fd, chunk.data() + written, chunk.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        written += n;
+    }
+    flock(fd, LOCK_UN);
+    close(fd);
+    if (written < chunk.size()) {
+        std::cerr << "Could not write analytics file " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------- reader
+
+AnalyticsReader::~AnalyticsReader() {
+    if (fd >= 0) close(fd);
+}
+
+bool AnalyticsReader::open(const std::string& file) {
+    path = file;
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    char magic[sizeof(file_magic)];
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        std::cerr << "Could not open analytics file " << path << ": " << strerror(errno) << "\n";
+        return false;
+    }
+    if (!read_at(fd, magic, sizeof(magic), 0) || std::memcmp(magic, file_magic, sizeof(magic)) != 0) {
+        std::cerr << path << " is not an analytics file\n";
+        return false;
+    }
+    size = static_cast<uint64_t>(info.st_size);
+    offset = sizeof(file_magic);
+    return true;
+}
+
+bool AnalyticsReader::next(const std::vector<int>& wanted, Chunk& chunk) {
+    while (offset + sizeof(ChunkHeader) <= size) {
+        ChunkHeader header = {};
+        std::vector<ColumnEntry> entries;
+        bool intact = read_at(fd, &header, sizeof(header), offset) &&
+                      std::memcmp(header.magic, chunk_magic, sizeof(chunk_magic)) == 0 &&
+                      header.column_count <= max_columns && header.payload_bytes >= header.column_count * sizeof(ColumnEntry) &&
+                      offset + sizeof(header) + header.payload_bytes <= size;
+        if (intact) {
+            entries.resize(header.column_count);
+            intact = read_at(fd, entries.data(), entries.size() * sizeof(ColumnEntry), offset + sizeof(header));
+        }
+
+        uint64_t column_offset = offset + sizeof(header) + header.column_count * sizeof(ColumnEntry);
+        uint64_t end = offset + sizeof(header) + (intact ? header.payload_bytes : 0);
+        chunk.rows = intact ? header.rows : 0;
+        chunk.names.clear();
+        for (size_t c = 0; intact && c < entries.size(); c++) {
+            if (column_offset + entries[c].bytes > end) {
+                intact = false;
+                break;
+            }
+            if (c < analytics_column_count && std::find(wanted.begin(), wanted.end(), c) != wanted.end()) {
+                buffer.resize(entries[c].bytes);
+                intact = read_at(fd, buffer.data(), buffer.size(), column_offset) &&
+                         checksum(buffer.data(), buffer.size()) == entries[c].checksum;
+                read_bytes += buffer.size();
+                const unsigned char* in = buffer.data();
+                const unsigned char* stop = in + buffer.size();
+                if (intact && c == col_robot) {
+                    uint64_t count, length;
+                    intact = get_varint(in, stop, count) && count <= chunk.rows;
+                    for (uint64_t n = 0; intact && n < count; n++) {
+                        intact = get_varint(in, stop, length) && length <= uint64_t(stop - in);
+                        if (intact) chunk.names.emplace_back(reinterpret_cast<const char*>(in), length);
+                        in += intact ? length : 0;
+                    }
+                }
+                intact = intact && decode_column(in, stop, chunk.rows, chunk.columns[c]);
+            }
+            column_offset += entries[c].bytes;
+        }
+        read_bytes += sizeof(header) + entries.size() * sizeof(ColumnEntry);
+
+        if (intact) {
+            // Columns this file predates read as zeros
+            for (int c : wanted) {
+                if (c >= static_cast<int>(header.column_count)) chunk.columns[c].assign(chunk.rows, 0);
+            }
+            offset = end;
+            return true;
+        }
+
+        // A torn or damaged chunk: pick up at the next chunk that starts after it
+        std::cerr << path << ": skipping damaged chunk at offset " << offset << "\n";
+        uint64_t search = offset + 1;
+        offset = size;
+        char window[65536];
+        while (search + sizeof(chunk_magic) <= size) {
+            size_t span = static_cast<size_t>(std::min<uint64_t>(sizeof(window), size - search));
+            if (!read_at(fd, window, span, search)) break;
+            char* found = static_cast<char*>(memmem(window, span, chunk_magic, sizeof(chunk_magic)));
+            if (found) {
+                offset = search + (found - window);
+                break;
+            }
+            search += span - (sizeof(chunk_magic) - 1);
+        }
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------- query
+
+int query_analytics(const std::string& path, const std::vector<std::string>& names) {
+    std::vector<int> stats;
+    for (const auto& name : names) {
+        int column = analytics_column(name);
+        if (column < 0 || column == col_robot || column == col_result) {
+            std::cerr << "Unknown statistic " << name << "; one of:";
+            for (int c = 0; c < analytics_column_count; c++) {
+                if (c != col_robot && c != col_result) std::cerr << " " << column_names[c];
+            }
+            std::cerr << "\n";
+            return 1;
+        }
+        stats.push_back(column);
+    }
+    if (stats.empty()) {
+        stats.push_back(col_rounds);
+        for (int c = col_health; c < analytics_column_count; c++) stats.push_back(c);
+    }
+
+    AnalyticsReader reader;
+    if (!reader.open(path)) return 1;
+    auto start = std::chrono::steady_clock::now();
+
+    struct Totals {
+        int64_t matches = 0, wins = 0, draws = 0, losses = 0;
+        std::vector<int64_t> sums;
+    };
+    std::map<std::string, Totals> robots;
+    std::vector<int> wanted = stats;
+    wanted.push_back(col_robot);
+    wanted.push_back(col_result);
+    AnalyticsReader::Chunk chunk;
+    std::vector<Totals*> by_code;
+    uint64_t rows = 0, chunks = 0;
+    while (reader.next(wanted, chunk)) {
+        by_code.clear();
+        for (const auto& name : chunk.names) {
+            Totals& totals = robots[name];
+            totals.sums.resize(stats.size());
+            by_code.push_back(&totals);
+        }
+        const std::vector<int64_t>& codes = chunk.columns[col_robot];
+        const std::vector<int64_t>& results = chunk.columns[col_result];
+        for (size_t r = 0; r < chunk.rows; r++) {
+            if (codes[r] < 0 || codes[r] >= static_cast<int64_t>(by_code.size())) continue;
+            Totals& totals = *by_code[codes[r]];
+            totals.matches++;
+            (results[r] > 0 ? totals.wins : results[r] < 0 ? totals.losses : totals.draws)++;
+        }
+        // Column at a time, the way the file is laid out
+        for (size_t s = 0; s < stats.size(); s++) {
+            const std::vector<int64_t>& values = chunk.columns[stats[s]];
+            for (size_t r = 0; r < chunk.rows; r++) {
+                if (codes[r] >= 0 && codes[r] < static_cast<int64_t>(by_code.size())) by_code[codes[r]]->sums[s] += values[r];
+            }
+        }
+        rows += chunk.rows;
+        chunks++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Per robot: matches, wins/draws/losses, then the mean of each statistic per match\n\n";
+    std::cout << std::left << std::setw(16) << "Robot" << std::right << std::setw(9) << "Matches" << std::setw(7) << "Wins"
+              << std::setw(7) << "Draws" << std::setw(8) << "Losses";
+    for (int column : stats) std::cout << std::setw(std::max<int>(10, std::strlen(column_names[column]) + 2)) << column_names[column];
+    std::cout << "\n" << std::fixed << std::setprecision(2);
+    for (const auto& [name, totals] : robots) {
+        std::cout << std::left << std::setw(16) << name << std::right << std::setw(9) << totals.matches
+                  << std::setw(7) << totals.wins << std::setw(7) << totals.draws << std::setw(8) << totals.losses;
+        for (size_t s = 0; s < stats.size(); s++) {
+            int width = std::max<int>(10, std::strlen(column_names[stats[s]]) + 2);
+            std::cout << std::setw(width) << double(totals.sums[s]) / std::max<int64_t>(totals.matches, 1);
+        }
+        std::cout << "\n";
+    }
+    std::cout << "\n" << rows << " rows in " << chunks << " chunks, " << reader.bytes_read() << " bytes read, "
+              << std::setprecision(3) << seconds << "s\n";
+    return 0;
+}
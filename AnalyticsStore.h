@@ -0,0 +1,90 @@
+#ifndef ANALYTICS_STORE_H
+#define ANALYTICS_STORE_H
+
+#include "MatchResult.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-robot match statistics in an append-only columnar file: one row per
+// robot per match. Rows are buffered and written in chunks, each column of a
+// chunk compressed on its own (deltas from the previous row as varints, runs
+// of repeats collapsed), so a query reads and decodes only the columns it
+// asks for. A chunk goes to the file in one append under an exclusive lock:
+// any number of arenas and tournaments can share a file, and a reader never
+// sees half a chunk from a live writer. A chunk cut short by a crash ends the
+// readable file there.
+enum AnalyticsColumn {
+    col_match,                           // tournament match id, 0 for a single match
+    col_seed,
+    col_rounds,                          // rounds the match lasted
+    col_robot,                           // name, dictionary-coded per chunk
+    col_result,                          // 1 won, 0 drew (no winner), -1 lost
+    col_health,
+    col_armor,
+    col_shots_flamethrower,
+    col_shots_railgun,
+    col_shots_grenade,
+    col_shots_hammer,
+    col_hits,
+    col_damage_dealt,
+    col_damage_taken,
+    col_pit_falls,
+    col_flame_burns,
+    col_rounds_survived,
+    col_distance_moved,
+    analytics_column_count
+};
+
+const char* analytics_column_name(int column);
+int analytics_column(const std::string& name);  // -1 if unknown
+
+class AnalyticsWriter {
+public:
+    explicit AnalyticsWriter(const std::string& path, size_t chunk_rows = 4096);
+    ~AnalyticsWriter();                  // flushes
+
+    AnalyticsWriter(const AnalyticsWriter&) = delete;
+    AnalyticsWriter& operator=(const AnalyticsWriter&) = delete;
+
+    // A row for every robot in the result
+    void append(uint64_t match, uint32_t seed, const MatchResult& result);
+    bool flush();                        // write buffered rows as a chunk
+
+private:
+    std::string path;
+    size_t chunk_rows;
+    size_t rows = 0;
+    std::vector<int64_t> columns[analytics_column_count];
+    std::vector<std::string> names;      // this chunk's robot dictionary
+};
+
+// Reads a file chunk by chunk; memory use is one chunk of the wanted columns.
+class AnalyticsReader {
+public:
+    struct Chunk {
+        size_t rows = 0;
+        std::vector<int64_t> columns[analytics_column_count];  // only the wanted ones filled
+        std::vector<std::string> names;  // col_robot values index this
+    };
+
+    ~AnalyticsReader();
+    bool open(const std::string& path);
+    // Next chunk with the wanted columns decoded; false at the end of the file
+    bool next(const std::vector<int>& wanted, Chunk& chunk);
+    uint64_t bytes_read() const { return read_bytes; }
+
+private:
+    std::string path;
+    int fd = -1;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    uint64_t read_bytes = 0;
+    std::vector<unsigned char> buffer;
+};
+
+// The --query tool: per-robot totals and per-match means of `columns` (every
+// statistic if empty) over the whole file. Returns the exit status.
+int query_analytics(const std::string& path, const std::vector<std::string>& columns);
+
+#endif // ANALYTICS_STORE_H
@@ -1,66 +1,180 @@
 #include "Arena.h"
+#include "WeaponPatterns.h"
+#include "MatchCache.h"
+#include "TraceRecorder.h"
+#include "RobotMemory.h"
+#include "MapFile.h"
+#include "AnalyticsStore.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <iomanip>
 #include <cstdlib>
 #include <ctime>
-#include <dlfcn.h>
 #include <unistd.h>
-#include <filesystem>
 #include <algorithm>
+#include <cctype>
+#include <new>
+#include <utility>
 
-Arena::Arena() : width(20), height(20), max_rounds(100), watch_live(true), current_round(0) {
-    srand(time(nullptr));
+template <typename Observer>
+BasicArena<Observer>::BasicArena()
+    : console(std::cout.rdbuf()), width(20), height(20), max_rounds(100), watch_live(true), current_round(0),
+      num_mounds(5), num_pits(2), num_flamethrowers(3),
+      seed(static_cast<unsigned>(time(nullptr))), seed_from_config(false), radar_engine("auto"),
+      stats_interval(10), think_ahead(false), think_ahead_threads(0) {
 }
 
-Arena::~Arena() {
+template <typename Observer>
+thread_local typename BasicArena<Observer>::Lane* BasicArena<Observer>::lane = nullptr;
+
+template <typename Observer>
+BasicArena<Observer>::~BasicArena() {
     for (auto robot : robots) {
         delete robot;
     }
-    for (auto handle : robot_handles) {
-        dlclose(handle);
+    for (int slot : memory_slots) {
+        RobotMemory::release_slot(slot);
+    }
+}
+
+template <typename Observer>
+bool BasicArena<Observer>::initialize(const std::string& config_file) {
+    std::ifstream file(config_file);
+    if (!file.is_open()) {
+        std::cerr << "Could not open config file, using defaults\n";
     }
+    return initialize(file);
+}
+
+template <typename Observer>
+bool BasicArena<Observer>::initialize(std::istream& config) {
+    load_config(config);
+    return set_up_match();
 }
 
-void Arena::initialize(const std::string& config_file) {
-    load_config(config_file);
+template <typename Observer>
+bool BasicArena<Observer>::initialize_replay(const std::string& config_file, const std::string& log_file) {
+    DecisionLogHeader header;
+    replay_log = std::make_unique<DecisionLogReader>();
+    if (!replay_log->open(log_file, header)) return false;
     
-    // Initialize grid
-    grid.resize(height, std::vector<char>(width, '.'));
+    std::ifstream file(config_file);
+    load_config(file);
+    seed = header.seed;
+    seed_from_config = true;
+    width = header.width;
+    height = header.height;
+    max_rounds = header.max_rounds;
+    num_mounds = header.num_mounds;
+    num_pits = header.num_pits;
+    num_flamethrowers = header.num_flamethrowers;
+    map_file = header.map_file;
+    terrain = header.terrain;
+    terrain_settings.mound_density = header.mound_density;
+    terrain_settings.pit_density = header.pit_density;
+    terrain_settings.flamethrower_density = header.flamethrower_density;
+    terrain_settings.smoothing = header.terrain_smoothing;
+    stalemate_rounds = header.stalemate_rounds;
+    stalemate_repeats = header.stalemate_repeats;
+    stalemate_tiebreak = header.stalemate_tiebreak;
+    simultaneous = header.simultaneous;
+    replay_robots = header.robots;
+    think_ahead = false;
     
-    // Place obstacles
-    int num_mounds = 5, num_pits = 2, num_flamethrowers = 3;
-    place_obstacles(num_mounds, num_pits, num_flamethrowers);
+    console << "\nReplaying " << log_file << " (seed " << seed << ")\n";
+    return set_up_match();
+}
+
+template <typename Observer>
+bool BasicArena<Observer>::set_up_match() {
+    rng.seed(seed);
+    
+    if (!map_file.empty()) {
+        // The map is the board: its size, obstacles and spawn points. A
+        // scenario played on some other board is not the scenario.
+        if (!load_map(map_file, grid, spawn_points)) return false;
+        height = grid.height();
+        width = grid.width();
+    } else {
+        if (terrain) {
+            terrain_settings.seed = seed;
+            generate_terrain(grid, height, width, terrain_settings);
+        } else {
+            // Initialize grid
+            grid.reset(height, width);
+            
+            // Place obstacles
+            place_obstacles(num_mounds, num_pits, num_flamethrowers);
+        }
+    }
     
     // Load robots
     load_robots();
+    lookahead.resize(robots.size());
+    choose_radar_engine();
+    
+    // Each robot draws from its own rand() stream, set from the match seed
+    // and its place in the roster whatever it did when it was constructed
+    for (size_t i = 0; i < robot_random.size(); i++) robot_random[i].seed(seed, i);
+    return true;
 }
 
-void Arena::load_config(const std::string& config_file) {
-    std::ifstream file(config_file);
-    if (!file.is_open()) {
-        std::cerr << "Could not open config file, using defaults\n";
-        return;
-    }
-    
+template <typename Observer>
+void BasicArena<Observer>::load_config(std::istream& config) {
     std::string key, value;
-    while (file >> key >> value) {
+    while (config >> key >> value) {
         if (key == "arena_width") width = std::stoi(value);
         else if (key == "arena_height") height = std::stoi(value);
         else if (key == "max_rounds") max_rounds = std::stoi(value);
+        else if (key == "num_mounds") num_mounds = std::stoi(value);
+        else if (key == "num_pits") num_pits = std::stoi(value);
+        else if (key == "num_flamethrowers") num_flamethrowers = std::stoi(value);
+        else if (key == "seed") { seed = static_cast<unsigned>(std::stoul(value)); seed_from_config = true; }
+        else if (key == "match_cache") match_cache_dir = value;
+        else if (key == "radar_engine") radar_engine = value;
+        else if (key == "think_ahead") think_ahead = (value == "yes");
+        else if (key == "think_ahead_threads") think_ahead_threads = std::stoi(value);
+        else if (key == "turn_mode") simultaneous = (value == "simultaneous");
+        else if (key == "turn_threads") turn_threads = std::max(0, std::stoi(value));
+        else if (key == "partition") partition = (value == "yes");
+        else if (key == "partition_threads") partition_threads = std::max(0, std::stoi(value));
         else if (key == "watch_live") watch_live = (value == "yes");
+        else if (key == "quiet" && value == "yes") console.setstate(std::ios::badbit);
+        else if (key == "stats_file") stats_file = value;
+        else if (key == "stats_interval") stats_interval = std::max(1, std::stoi(value));
+        else if (key == "map") map_file = value;
+        else if (key == "terrain") terrain = (value == "yes");
+        else if (key == "mound_density") terrain_settings.mound_density = std::stod(value);
+        else if (key == "pit_density") terrain_settings.pit_density = std::stod(value);
+        else if (key == "flamethrower_density") terrain_settings.flamethrower_density = std::stod(value);
+        else if (key == "terrain_smoothing") terrain_settings.smoothing = std::stoi(value);
+        else if (key == "terrain_threads") terrain_settings.threads = std::stoi(value);
+        else if (key == "robot_memory_quota") robot_memory_quota = parse_bytes(value);
+        else if (key == "analytics_file") analytics_file = value;
+        else if (key == "broadcast") broadcast_path = value;
+        else if (key == "stalemate_rounds") stalemate_rounds = std::max(0, std::stoi(value));
+        else if (key == "stalemate_repeats") stalemate_repeats = std::max(0, std::stoi(value));
+        else if (key == "stalemate_tiebreak") stalemate_tiebreak = value;
+        else if (key == "broadcast_delay") broadcast_delay = std::max(0, std::stoi(value));
+        else if (key == "robots") {
+            std::istringstream names(value);
+            std::string name;
+            while (std::getline(names, name, ',')) roster.push_back(name);
+        }
     }
 }
 
-void Arena::place_obstacles(int num_mounds, int num_pits, int num_flamethrowers) {
+template <typename Observer>
+void BasicArena<Observer>::place_obstacles(int num_mounds, int num_pits, int num_flamethrowers) {
     auto place_random = [&](char type, int count) {
         for (int i = 0; i < count; i++) {
             int row, col;
             do {
-                row = rand() % height;
-                col = rand() % width;
-            } while (grid[row][col] != '.');
-            grid[row][col] = type;
+                row = roll(height);
+                col = roll(width);
+            } while (grid.at(row, col) != '.');
+            set_cell(row, col, type);
         }
     };
     
@@ -69,104 +183,111 @@ void Arena::place_obstacles(int num_mounds, int num_pits, int num_flamethrowers)
     place_random('F', num_flamethrowers);
 }
 
-void Arena::compile_robot(const std::string& cpp_file) {
-    std::string robot_name = cpp_file.substr(6, cpp_file.length() - 10); // Strip "Robot_" and ".cpp"
-    std::string so_file = "lib" + robot_name + ".so";
+template <typename Observer>
+void BasicArena<Observer>::load_robots() {
+    console << "\nLoading Robots...\n";
     
-    std::string cmd = "g++ -std=c++20 -fPIC -shared " + cpp_file + " RobotBase.o -o " + so_file;
-    std::cout << "Compiling " << cpp_file << " to " << so_file << "...\n";
-    
-    int result = system(cmd.c_str());
-    if (result != 0) {
-        std::cerr << "Failed to compile " << cpp_file << "\n";
-    }
-}
-
-RobotBase* Arena::load_robot_library(const std::string& so_file, void*& handle) {
-    std::string full_path = "./" + so_file;  // Add ./ prefix
-    handle = dlopen(full_path.c_str(), RTLD_LAZY);
-    if (!handle) {
-        std::cerr << "Failed to load " << so_file << ": " << dlerror() << "\n";
-        return nullptr;
+    if (replay_log) {
+        // Stand-ins with the recorded stats; the log decides for them. They
+        // run no robot code, so they take no memory slot.
+        for (const auto& entry : replay_robots) {
+            add_robot(new ReplayRobot(entry.move, entry.armor, entry.weapon), entry.name, nullptr, nullptr, nullptr, 0);
+        }
+        return;
     }
     
-    typedef RobotBase* (*RobotFactory)();
-    RobotFactory create_robot = (RobotFactory)dlsym(handle, "create_robot");
-    if (!create_robot) {
-        std::cerr << "Failed to find create_robot in " << so_file << "\n";
-        dlclose(handle);
-        return nullptr;
+    for (int i = 0; i < learner_count; i++) {
+        add_robot(new ReplayRobot(learner_stats.move, learner_stats.armor, learner_stats.weapon),
+                  "Learner" + std::to_string(i + 1), nullptr, nullptr, nullptr, 0);
     }
     
-    return create_robot();
+    // The registry loads each robot's code once per process; here it is only a new
+    for (const auto& robot_name : RobotLibraries::available(roster)) {
+        RobotLibraries::Ref library = RobotLibraries::acquire(robot_name);
+        if (!library) continue;
+        
+        int slot = RobotMemory::claim_slot();
+        if (slot == 0 && robot_memory_quota > 0) {
+            std::cerr << "No memory slot left for " << robot_name << ": its quota is not enforced\n";
+        }
+        RobotBase* robot;
+        TurnPlanner* planner;
+        RadarBeamReceiver* beam_receiver;
+        {
+            RobotMemoryScope scope(slot);
+            robot = library->create();
+            planner = (robot && library->planner) ? library->planner(robot) : nullptr;
+            beam_receiver = (robot && library->beam_receiver) ? library->beam_receiver(robot) : nullptr;
+        }
+        add_robot(robot, robot_name, library, planner, beam_receiver, slot);
+    }
 }
 
-void Arena::load_robots() {
-    std::cout << "\nLoading Robots...\n";
-    
-    // Find all Robot_*.cpp files
-    std::vector<std::string> robot_files;
-    for (const auto& entry : std::filesystem::directory_iterator(".")) {
-        std::string filename = entry.path().filename().string();
-        if (filename.substr(0, 6) == "Robot_" && filename.substr(filename.length() - 4) == ".cpp") {
-            robot_files.push_back(filename);
-        }
+template <typename Observer>
+void BasicArena<Observer>::add_robot(RobotBase* robot, const std::string& robot_name, RobotLibraries::Ref library,
+                                     TurnPlanner* planner, RadarBeamReceiver* beam_receiver, int slot) {
+    if (!robot) {
+        RobotMemory::release_slot(slot);
+        return;
     }
+    RobotMemory::set_quota(slot, robot_memory_quota);
     
     char symbols[] = {'!', '@', '#', '$', '%', '&', '*', '+', '='};
-    int symbol_idx = 0;
+    robot->set_boundaries(height, width);
+    robot->m_name = robot_name;
+    robot->m_character = symbols[robots.size() % 9];
     
-    for (const auto& cpp_file : robot_files) {
-        compile_robot(cpp_file);
-        
-        std::string robot_name = cpp_file.substr(6, cpp_file.length() - 10);
-        std::string so_file = "lib" + robot_name + ".so";
-        
-        void* handle;
-        RobotBase* robot = load_robot_library(so_file, handle);
-        
-        if (robot) {
-            robot->set_boundaries(height, width);
-            robot->m_name = robot_name;
-            robot->m_character = symbols[symbol_idx % 9];
-            
-            place_robot(robot, robot->m_character);
-            
-            robots.push_back(robot);
-            robot_handles.push_back(handle);
-            robot_symbols[robot] = robot->m_character;
-            
-            int r, c;
-            robot->get_current_location(r, c);
-            std::cout << "Loaded robot: " << robot_name << " at (" << r << ", " << c << ")\n";
-            
-            symbol_idx++;
-        }
-    }
+    place_robot(robot, robot->m_character);
+    
+    robots.push_back(robot);
+    planners.push_back(planner);
+    beam_receivers.push_back(beam_receiver);
+    robot_libraries.push_back(std::move(library));
+    memory_slots.push_back(slot);
+    robot_random.emplace_back();
+    robot_stats.emplace_back();
+    robot_symbols[robot] = robot->m_character;
+    robot_index[robot] = robots.size() - 1;
+    
+    int r, c;
+    robot->get_current_location(r, c);
+    console << "Loaded robot: " << robot_name << " at (" << r << ", " << c << ")"
+              << (planner ? " (plans ahead)" : "") << "\n";
 }
 
-void Arena::place_robot(RobotBase* robot, char symbol) {
+template <typename Observer>
+void BasicArena<Observer>::place_robot(RobotBase* robot, char symbol) {
     int row, col;
-    do {
-        row = rand() % height;
-        col = rand() % width;
-    } while (grid[row][col] != '.');
+    size_t next = robots.size();
+    if (next < spawn_points.size() && grid.at(spawn_points[next].row, spawn_points[next].col) == '.') {
+        row = spawn_points[next].row;
+        col = spawn_points[next].col;
+    } else {
+        do {
+            row = roll(height);
+            col = roll(width);
+        } while (grid.at(row, col) != '.');
+    }
     
-    grid[row][col] = 'R';
+    set_cell(row, col, 'R');
     robot->move_to(row, col);
 }
 
-void Arena::print_arena() {
-    std::cout << "\n     ";
+template <typename Observer>
+void BasicArena<Observer>::print_arena() {
+    PhaseTimer timer(stats, Phase::render);
+    TraceSpan span("print_arena");
+    
+    console << "\n     ";
     for (int c = 0; c < width; c++) {
-        std::cout << c % 10 << "  ";
+        console << c % 10 << "  ";
     }
-    std::cout << "\n";
+    console << "\n";
     
     for (int r = 0; r < height; r++) {
-        std::cout << (r < 10 ? " " : "") << r << "  ";
+        console << (r < 10 ? " " : "") << r << "  ";
         for (int c = 0; c < width; c++) {
-            char cell = grid[r][c];
+            char cell = grid.at(r, c);
             if (cell == 'R') {
                 // Find which robot is here
                 for (auto robot : robots) {
@@ -174,168 +295,160 @@ void Arena::print_arena() {
                     robot->get_current_location(rr, cc);
                     if (rr == r && cc == c) {
                         if (robot->get_health() > 0) {
-                            std::cout << " R" << robot->m_character;
+                            console << " R" << robot->m_character;
                         } else {
-                            std::cout << " X" << robot->m_character;
+                            console << " X" << robot->m_character;
                         }
                         break;
                     }
                 }
             } else {
-                std::cout << "  " << cell;
+                console << "  " << cell;
             }
         }
-        std::cout << "\n";
+        console << "\n";
     }
 }
 
-void Arena::print_robot_stats(RobotBase* robot, char symbol) {
+template <typename Observer>
+void BasicArena<Observer>::print_robot_stats(RobotBase* robot, char symbol) {
     int r, c;
     robot->get_current_location(r, c);
     
     if (robot->get_health() <= 0) {
-        std::cout << robot->m_name << " " << symbol << " - is out\n";
+        commentary() << robot->m_name << " " << symbol << " - is out\n";
     } else {
-        std::cout << robot->m_name << " " << symbol << " (" << r << "," << c << ") Health: " 
+        commentary() << robot->m_name << " " << symbol << " (" << r << "," << c << ") Health: " 
                   << robot->get_health() << " Armor: " << robot->get_armor() << "\n";
     }
 }
 
-std::vector<RadarObj> Arena::scan_radar(RobotBase* robot, int direction) {
-    std::vector<RadarObj> results;
+// Fills results (reused turn after turn, so it stops allocating once it has grown)
+template <typename Observer>
+void BasicArena<Observer>::scan_radar(RobotBase* robot, int direction, std::vector<RadarObj>& results) {
+    PhaseTimer timer(turn_stats(), Phase::radar);
+    TraceSpan span("scan_radar");
+    results.clear();
+    if (direction < 0 || direction > 8) return;  // bogus direction sees nothing
+    turn_stats().radar_scans[direction]++;
+    
     int robot_row, robot_col;
     robot->get_current_location(robot_row, robot_col);
-    
-    if (direction == 0) {
-        // Scan 8 adjacent cells
-        for (int dr = -1; dr <= 1; dr++) {
-            for (int dc = -1; dc <= 1; dc++) {
-                if (dr == 0 && dc == 0) continue;  // Skip robot's own position
-                int nr = robot_row + dr;
-                int nc = robot_col + dc;
-                if (in_bounds(nr, nc)) {
-                    char cell = grid[nr][nc];
-                    if (cell != '.') {
-                        // Don't report robot's own position
-                        if (!(nr == robot_row && nc == robot_col)) {
-                            results.push_back(RadarObj(cell, nr, nc));
-                        }
-                    }
-                }
-            }
-        }
-    } else {
-        // Directional scan (3 cells wide)
-        auto [dr, dc] = directions[direction];
-        
-        for (int dist = 1; dist < std::max(height, width); dist++) {
-            for (int offset = -1; offset <= 1; offset++) {
-                int nr = robot_row + dr * dist;
-                int nc = robot_col + dc * dist;
-                
-                // Apply perpendicular offset for 3-wide beam
-                if (dr == 0) nr += offset;
-                else if (dc == 0) nc += offset;
-                else { 
-                    if (offset == -1) { nr -= 1; }
-                    else if (offset == 1) { nc += 1; }
-                }
-                
-                if (in_bounds(nr, nc)) {
-                    char cell = grid[nr][nc];
-                    if (cell != '.') {
-                        results.push_back(RadarObj(cell, nr, nc));
-                    }
-                }
-            }
-        }
+    std::shared_lock<std::shared_mutex> lock(board_mutex, std::defer_lock);
+    if (board_shared) lock.lock();
+    radar->scan(robot_row, robot_col, direction, results, turn_scratch().resource());
+}
+
+template <typename Observer>
+void BasicArena<Observer>::choose_radar_engine() {
+    std::string engine = radar_engine;
+    if (engine == "auto") {
+        double density = double(grid.count_objects()) / (double(width) * height);
+        engine = density >= dense_radar_threshold ? "dense" : "sparse";
+    }
+    radar = (engine == "dense") ? make_dense_radar(grid) : make_sparse_radar(grid);
+    console << "Radar engine: " << radar->name() << "\n";
+}
+
+template <typename Observer>
+void BasicArena<Observer>::handle_shot(RobotBase* shooter, int shot_row, int shot_col) {
+    PhaseTimer timer(turn_stats(), Phase::shot);
+    TraceSpan span("handle_shot");
+    turn_stats().shots[shooter->get_weapon()]++;
+    stats_of(shooter).shots[shooter->get_weapon()]++;
+    if constexpr (observes_events<Observer>) {
+        observer.shot({current_round + 1, shooter, shooter->get_weapon(), shot_row, shot_col});
     }
     
-    return results;
+    switch (shooter->get_weapon()) {
+        case railgun:      resolve_shot<railgun>(shooter, shot_row, shot_col); break;
+        case grenade:      resolve_shot<grenade>(shooter, shot_row, shot_col); break;
+        case hammer:       resolve_shot<hammer>(shooter, shot_row, shot_col); break;
+        case flamethrower: resolve_shot<flamethrower>(shooter, shot_row, shot_col); break;
+    }
+    commentary() << "\n";
 }
 
-void Arena::handle_shot(RobotBase* shooter, int shot_row, int shot_col) {
-    WeaponType weapon = shooter->get_weapon();
+template <typename Observer>
+template <WeaponType W>
+void BasicArena<Observer>::resolve_shot(RobotBase* shooter, int shot_row, int shot_col) {
+    using Pattern = WeaponPattern<W>;
     int shooter_row, shooter_col;
     shooter->get_current_location(shooter_row, shooter_col);
     
-    std::cout << "  firing " << (weapon == railgun ? "railgun" : weapon == hammer ? "hammer" : 
-                                 weapon == grenade ? "grenade" : "flamethrower");
+    commentary() << "  firing " << Pattern::name;
     
-    std::vector<std::pair<int,int>> hit_cells;
+    int direction = direction_toward(shooter_row, shooter_col, shot_row, shot_col);
     
-    if (weapon == railgun) {
+    if constexpr (!Pattern::fixed) {
         // Shoot through everything to edge
-        int dr = (shot_row > shooter_row) ? 1 : (shot_row < shooter_row) ? -1 : 0;
-        int dc = (shot_col > shooter_col) ? 1 : (shot_col < shooter_col) ? -1 : 0;
-        
-        int r = shooter_row + dr;
-        int c = shooter_col + dc;
-        while (in_bounds(r, c)) {
-            hit_cells.push_back({r, c});
-            r += dr;
-            c += dc;
-        }
-    } else if (weapon == grenade) {
-        // 3x3 splash at target
-        for (int dr = -1; dr <= 1; dr++) {
-            for (int dc = -1; dc <= 1; dc++) {
-                int r = shot_row + dr;
-                int c = shot_col + dc;
-                if (in_bounds(r, c)) {
-                    hit_cells.push_back({r, c});
-                }
-            }
+        if (direction == 0) return;
+        auto [dr, dc] = directions[direction];
+        for (int r = shooter_row + dr, c = shooter_col + dc; in_bounds(r, c); r += dr, c += dc) {
+            hit_cell(shooter, W, r, c);
         }
-        shooter->decrement_grenades();
-    } else if (weapon == hammer) {
-        // Just one cell (must be adjacent)
-        if (abs(shot_row - shooter_row) <= 1 && abs(shot_col - shooter_col) <= 1) {
-            hit_cells.push_back({shot_row, shot_col});
+    } else {
+        if constexpr (W == grenade) {
+            shooter->decrement_grenades();
         }
-    } else if (weapon == flamethrower) {
-        // 4 cells in direction, 3 wide
-        int dr = (shot_row > shooter_row) ? 1 : (shot_row < shooter_row) ? -1 : 0;
-        int dc = (shot_col > shooter_col) ? 1 : (shot_col < shooter_col) ? -1 : 0;
+        if (!Pattern::in_reach(shooter_row, shooter_col, shot_row, shot_col)) return;
         
-        for (int dist = 1; dist <= 4; dist++) {
-            for (int offset = -1; offset <= 1; offset++) {
-                int r = shooter_row + dr * dist;
-                int c = shooter_col + dc * dist;
-                if (dr == 0) r += offset;
-                else if (dc == 0) c += offset;
-                
-                if (in_bounds(r, c)) {
-                    hit_cells.push_back({r, c});
-                }
+        int origin_row = Pattern::at_target ? shot_row : shooter_row;
+        int origin_col = Pattern::at_target ? shot_col : shooter_col;
+        for (auto [dr, dc] : Pattern::offsets(direction)) {
+            int r = origin_row + dr;
+            int c = origin_col + dc;
+            if (in_bounds(r, c)) {
+                hit_cell(shooter, W, r, c);
             }
         }
     }
+}
+
+// Apply damage to any living robot (other than the shooter) standing in the cell
+template <typename Observer>
+void BasicArena<Observer>::hit_cell(RobotBase* shooter, WeaponType weapon, int r, int c) {
+    if (grid.at(r, c) != 'R') return;
     
-    // Apply damage to robots in hit cells
-    for (auto [r, c] : hit_cells) {
-        for (auto target : robots) {
-            int tr, tc;
-            target->get_current_location(tr, tc);
-            if (tr == r && tc == c && target != shooter && target->get_health() > 0) {
-                int damage = calculate_damage(weapon);
-                int health_before = target->get_health();
-                target->take_damage(damage);
-                target->reduce_armor(1);
-                std::cout << " at (" << r << "," << c << ")";
-                std::cout << "\n  " << target->m_name << " takes " << damage << " damage. Health: " 
-                          << target->get_health();
-                
-                if (target->get_health() <= 0) {
-                    std::cout << " - DESTROYED!";
-                }
+    // On a lane only the robots whose zones overlap the shooter's can be here;
+    // the others may be moving on other lanes
+    auto hit = [&](RobotBase* target) {
+        int tr, tc;
+        target->get_current_location(tr, tc);
+        if (tr == r && tc == c && target != shooter && target->get_health() > 0) {
+            int damage = calculate_damage(weapon);
+            target->take_damage(damage);
+            target->reduce_armor(1);
+            MatchResult::RobotStats& shooter_stats = stats_of(shooter);
+            shooter_stats.hits++;
+            shooter_stats.damage_dealt += damage;
+            note_damage(target, damage);
+            if constexpr (observes_events<Observer>) {
+                observer.hit({current_round + 1, shooter, target, weapon, r, c, damage});
+                if (target->get_health() <= 0) observer.death({current_round + 1, target, shooter});
+            }
+            commentary() << " at (" << r << "," << c << ")";
+            commentary() << "\n  " << target->m_name << " takes " << damage << " damage. Health: " 
+                      << target->get_health();
+            
+            if (target->get_health() <= 0) {
+                commentary() << " - DESTROYED!";
             }
         }
+    };
+    if (lane) {
+        for (size_t i : partition_plan.overlapping(lane->index)) hit(robots[i]);
+    } else {
+        for (auto target : robots) hit(target);
     }
-    std::cout << "\n";
 }
 
-void Arena::handle_movement(RobotBase* robot, int direction, int distance) {
+template <typename Observer>
+void BasicArena<Observer>::handle_movement(RobotBase* robot, int direction, int distance) {
+    PhaseTimer timer(turn_stats(), Phase::move);
+    TraceSpan span("handle_movement");
+    turn_stats().moves++;
+    
     int curr_row, curr_col;
     robot->get_current_location(curr_row, curr_col);
     
@@ -352,23 +465,19 @@ void Arena::handle_movement(RobotBase* robot, int direction, int distance) {
         
         if (!in_bounds(next_row, next_col)) break;
         
-        char cell = grid[next_row][next_col];
+        char cell = grid.at(next_row, next_col);
         
         if (cell == 'M' || cell == 'R') {
             break; // Hit obstacle or robot
         } else if (cell == 'P') {
             new_row = next_row;
             new_col = next_col;
-            robot->disable_movement();
-            std::cout << "  " << robot->m_name << " fell in a pit!\n";
+            fall_in_pit(robot, new_row, new_col);
             break;
         } else if (cell == 'F') {
             new_row = next_row;
             new_col = next_col;
-            int damage = calculate_damage(flamethrower);
-            robot->take_damage(damage);
-            robot->reduce_armor(1);
-            std::cout << "  " << robot->m_name << " passed through flames! Takes " << damage << " damage.\n";
+            burn(robot, new_row, new_col);
         } else {
             new_row = next_row;
             new_col = next_col;
@@ -376,26 +485,55 @@ void Arena::handle_movement(RobotBase* robot, int direction, int distance) {
     }
     
     if (new_row != curr_row || new_col != curr_col) {
-        grid[curr_row][curr_col] = '.';
-        grid[new_row][new_col] = 'R';
+        set_cell(curr_row, curr_col, '.');
+        set_cell(new_row, new_col, 'R');
         robot->move_to(new_row, new_col);
-        std::cout << "  moving to (" << new_row << "," << new_col << ")\n";
+        stats_of(robot).distance_moved += std::max(std::abs(new_row - curr_row), std::abs(new_col - curr_col));
+        if constexpr (observes_events<Observer>) {
+            observer.move({current_round + 1, robot, curr_row, curr_col, new_row, new_col});
+        }
+        commentary() << "  moving to (" << new_row << "," << new_col << ")\n";
     } else {
-        std::cout << "  not moving\n";
+        commentary() << "  not moving\n";
     }
 }
 
-int Arena::calculate_damage(WeaponType weapon) {
+template <typename Observer>
+void BasicArena<Observer>::fall_in_pit(RobotBase* robot, int row, int col) {
+    robot->disable_movement();
+    stats_of(robot).pit_falls++;
+    if constexpr (observes_events<Observer>) observer.pit({current_round + 1, robot, row, col});
+    commentary() << "  " << robot->m_name << " fell in a pit!\n";
+}
+
+// Moving through a flamethrower cell
+template <typename Observer>
+void BasicArena<Observer>::burn(RobotBase* robot, int row, int col) {
+    int damage = calculate_damage(flamethrower);
+    robot->take_damage(damage);
+    robot->reduce_armor(1);
+    stats_of(robot).flame_burns++;
+    note_damage(robot, damage);
+    if constexpr (observes_events<Observer>) {
+        observer.flame_damage({current_round + 1, robot, row, col, damage});
+        if (robot->get_health() <= 0) observer.death({current_round + 1, robot, nullptr});
+    }
+    commentary() << "  " << robot->m_name << " passed through flames! Takes " << damage << " damage.\n";
+}
+
+template <typename Observer>
+int BasicArena<Observer>::calculate_damage(WeaponType weapon) {
     switch (weapon) {
-        case railgun: return 10 + rand() % 11;
-        case hammer: return 50 + rand() % 11;
-        case grenade: return 10 + rand() % 31;
-        case flamethrower: return 30 + rand() % 21;
+        case railgun: return 10 + roll(11);
+        case hammer: return 50 + roll(11);
+        case grenade: return 10 + roll(31);
+        case flamethrower: return 30 + roll(21);
     }
     return 0;
 }
 
-bool Arena::check_winner() {
+template <typename Observer>
+bool BasicArena<Observer>::check_winner() {
     int alive = 0;
     RobotBase* survivor = nullptr;
     for (auto robot : robots) {
@@ -406,83 +544,1068 @@ bool Arena::check_winner() {
     }
     
     if (alive == 1) {
-        std::cout << "\n\n*** WINNER: " << survivor->m_name << " ***\n\n";
-        return true;
+        result.outcome = "winner";
+        result.winner = survivor->m_name;
     } else if (alive == 0) {
-        std::cout << "\n\n*** NO SURVIVORS ***\n\n";
-        return true;
+        result.outcome = "no_survivors";
+    } else {
+        return false;
+    }
+    
+    print_result();
+    return true;
+}
+
+// A match that has stopped going anywhere: nobody has taken damage for
+// stalemate_rounds rounds, or every robot is back where it was, with the same
+// health, armor and grenades, for the stalemate_repeats-th time since anyone
+// last did. The tiebreak then picks the winner among the living, or a draw.
+template <typename Observer>
+bool BasicArena<Observer>::check_stalemate() {
+    bool quiet = stalemate_rounds > 0 && current_round + 1 - last_damage_round >= stalemate_rounds;
+    if (!quiet && !(stalemate_repeats > 0 && position_repeats() >= stalemate_repeats)) return false;
+    
+    stalemate_reason = quiet ? "no damage for " + std::to_string(stalemate_rounds) + " rounds"
+                             : "same position " + std::to_string(stalemate_repeats) + " times";
+    result.outcome = "stalemate";
+    
+    // Ranked by health, then (health_armor) armor; a tie at the top is a draw
+    auto rank = [this](RobotBase* robot) {
+        return std::make_pair(robot->get_health(), stalemate_tiebreak == "health_armor" ? robot->get_armor() : 0);
+    };
+    RobotBase* best = nullptr;
+    bool tied = false;
+    for (auto robot : robots) {
+        if (robot->get_health() <= 0) continue;
+        if (!best || rank(robot) > rank(best)) {
+            best = robot;
+            tied = false;
+        } else if (rank(robot) == rank(best)) {
+            tied = true;
+        }
+    }
+    if (stalemate_tiebreak != "draw" && best && !tied) result.winner = best->m_name;
+    
+    print_result();
+    return true;
+}
+
+// Records this round's position; how many times it has now been seen since
+// the last damage (within the ring)
+template <typename Observer>
+int BasicArena<Observer>::position_repeats() {
+    if (recent_positions.empty()) {
+        recent_positions.assign(stalemate_rounds > 0 ? stalemate_rounds : position_window, 0);
+    }
+    uint64_t hash = position_hash();
+    int seen = 1;
+    for (size_t i = 0; i < recent_count; i++) seen += recent_positions[i] == hash;
+    recent_positions[recent_next] = hash;
+    recent_next = (recent_next + 1) % recent_positions.size();
+    recent_count = std::min(recent_count + 1, recent_positions.size());
+    return seen;
+}
+
+// FNV-1a over every robot's position, health, armor and grenades. Only robots
+// move, so this is the whole state of the board that can change.
+template <typename Observer>
+uint64_t BasicArena<Observer>::position_hash() {
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](int value) {
+        for (int i = 0; i < 4; i++) {
+            hash ^= static_cast<uint8_t>(value >> (8 * i));
+            hash *= 1099511628211ull;
+        }
+    };
+    for (auto robot : robots) {
+        int row, col;
+        robot->get_current_location(row, col);
+        mix(row);
+        mix(col);
+        mix(robot->get_health());
+        mix(robot->get_armor());
+        mix(robot->get_grenades());
+    }
+    return hash;
+}
+
+template <typename Observer>
+void BasicArena<Observer>::print_result() const {
+    if (result.outcome == "winner") {
+        console << "\n\n*** WINNER: " << result.winner << " ***\n\n";
+    } else if (result.outcome == "no_survivors") {
+        console << "\n\n*** NO SURVIVORS ***\n\n";
+    } else if (result.outcome == "max_rounds") {
+        console << "\n\nMax rounds reached. Game over.\n";
+    } else if (result.outcome == "stalemate") {
+        console << "\n\n*** STALEMATE" << (stalemate_reason.empty() ? "" : ": " + stalemate_reason) << " ***\n";
+        if (!result.winner.empty()) {
+            console << "*** WINNER on " << stalemate_tiebreak << ": " << result.winner << " ***\n\n";
+        } else {
+            console << "*** DRAW ***\n\n";
+        }
+    }
+}
+
+template <typename Observer>
+void BasicArena<Observer>::record_robot_results() {
+    result.rounds = std::min(current_round + 1, max_rounds);
+    result.robots.clear();
+    for (size_t i = 0; i < robots.size(); i++) {
+        RobotBase* robot = robots[i];
+        if (robot->get_health() > 0) robot_stats[i].rounds_survived = result.rounds;
+        result.robots.push_back({robot->m_name, robot->get_health(), robot->get_armor(), robot_stats[i]});
+    }
+}
+
+// Send spectators the board and robots as they are now
+template <typename Observer>
+void BasicArena<Observer>::publish_round(int rounds_played) {
+    PhaseTimer timer(stats, Phase::render);
+    TraceSpan span("publish_round");
+    std::vector<SpectatorRobot> states;
+    for (auto robot : robots) {
+        SpectatorRobot state;
+        state.name = robot->m_name;
+        state.symbol = robot->m_character;
+        state.health = robot->get_health();
+        state.armor = robot->get_armor();
+        robot->get_current_location(state.row, state.col);
+        states.push_back(state);
+    }
+    broadcast->publish(rounds_played, grid, states);
+    if (broadcast_delay > 0) usleep(broadcast_delay * 1000);
+}
+
+template <typename Observer>
+void BasicArena<Observer>::end_round_event() {
+    int alive = std::count_if(robots.begin(), robots.end(), [](RobotBase* robot) { return robot->get_health() > 0; });
+    observer.round_end({current_round + 1, alive});
+}
+
+template <typename Observer>
+MatchResult::RobotStats& BasicArena<Observer>::stats_of(RobotBase* robot) {
+    return robot_stats[robot_index.at(robot)];
+}
+
+// Damage taken by `robot`; if it was fatal, the robot survived the rounds before this one
+template <typename Observer>
+void BasicArena<Observer>::note_damage(RobotBase* robot, int damage) {
+    MatchResult::RobotStats& robot_record = stats_of(robot);
+    robot_record.damage_taken += damage;
+    if (lane) {
+        lane->damage = true;  // the round's end takes it from there
+    } else {
+        last_damage_round = current_round + 1;
+        recent_count = recent_next = 0;
+    }
+    if (robot->get_health() <= 0) robot_record.rounds_survived = current_round;
+}
+
+template <typename Observer>
+void BasicArena<Observer>::print_robot_memory() const {
+    console << "\nRobot heap (current / peak bytes):\n";
+    for (size_t i = 0; i < robots.size(); i++) {
+        // Slot 0 is everything untagged, not this robot
+        if (memory_slots[i] == 0) {
+            console << "  " << robots[i]->m_name << ": untracked\n";
+            continue;
+        }
+        console << "  " << robots[i]->m_name << ": " << RobotMemory::current_bytes(memory_slots[i]) << " / "
+                  << RobotMemory::peak_bytes(memory_slots[i]) << "\n";
+    }
+}
+
+// "65536", "64K", "16M" or "1G"
+template <typename Observer>
+int64_t BasicArena<Observer>::parse_bytes(const std::string& value) {
+    size_t used = 0;
+    int64_t bytes = std::stoll(value, &used);
+    switch (used < value.size() ? std::toupper(static_cast<unsigned char>(value[used])) : 0) {
+        case 'G': bytes <<= 10; [[fallthrough]];
+        case 'M': bytes <<= 10; [[fallthrough]];
+        case 'K': bytes <<= 10; break;
+    }
+    return bytes;
+}
+
+template <typename Observer>
+void BasicArena<Observer>::open_decision_log() {
+    if (record_path.empty() || replay_log) return;
+    
+    DecisionLogHeader header;
+    header.seed = seed;
+    header.width = width;
+    header.height = height;
+    header.max_rounds = max_rounds;
+    header.num_mounds = num_mounds;
+    header.num_pits = num_pits;
+    header.num_flamethrowers = num_flamethrowers;
+    header.map_file = map_file;
+    header.terrain = terrain;
+    header.mound_density = terrain_settings.mound_density;
+    header.pit_density = terrain_settings.pit_density;
+    header.flamethrower_density = terrain_settings.flamethrower_density;
+    header.terrain_smoothing = terrain_settings.smoothing;
+    header.stalemate_rounds = stalemate_rounds;
+    header.stalemate_repeats = stalemate_repeats;
+    header.stalemate_tiebreak = stalemate_tiebreak;
+    header.simultaneous = simultaneous;
+    for (auto robot : robots) {
+        header.robots.push_back({robot->m_name, robot->get_move_speed(), robot->get_armor(), robot->get_weapon()});
     }
     
+    decision_log = std::make_unique<DecisionLogWriter>();
+    if (!decision_log->open(record_path, header)) decision_log.reset();
+}
+
+// The replayed round must end in the state the recording saw
+template <typename Observer>
+bool BasicArena<Observer>::check_replay_round() {
+    uint64_t recorded;
+    if (!replay_diverged && replay_log->next_round_end(recorded) && recorded == state_checksum()) return true;
+    
+    std::cerr << "Replay diverged from the recording in round " << current_round + 1 << "\n";
+    replay_diverged = true;
     return false;
 }
 
-bool Arena::in_bounds(int row, int col) const {
+// FNV-1a over the board and every robot's position, health, armor and grenades
+template <typename Observer>
+uint64_t BasicArena<Observer>::state_checksum() {
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](int value) {
+        for (int i = 0; i < 4; i++) {
+            hash ^= static_cast<uint8_t>(value >> (8 * i));
+            hash *= 1099511628211ull;
+        }
+    };
+    for (int r = 0; r < height; r++) {
+        for (int c = 0; c < width; c++) {
+            mix(grid.at(r, c));
+        }
+    }
+    for (auto robot : robots) {
+        int row, col;
+        robot->get_current_location(row, col);
+        mix(row);
+        mix(col);
+        mix(robot->get_health());
+        mix(robot->get_armor());
+        mix(robot->get_grenades());
+    }
+    return hash;
+}
+
+// Only the settings that change how a match plays out, in a fixed order.
+template <typename Observer>
+std::string BasicArena<Observer>::normalized_config() const {
+    std::ostringstream config;
+    config << "arena_width " << width << "\n";
+    config << "arena_height " << height << "\n";
+    config << "max_rounds " << max_rounds << "\n";
+    config << "num_mounds " << num_mounds << "\n";
+    config << "num_pits " << num_pits << "\n";
+    config << "num_flamethrowers " << num_flamethrowers << "\n";
+    if (!map_file.empty()) {
+        config << "map " << std::hex << MatchCache::hash_file(map_file) << std::dec << "\n";
+    } else if (terrain) {
+        config << std::setprecision(17);
+        config << "terrain yes\n";
+        config << "mound_density " << terrain_settings.mound_density << "\n";
+        config << "pit_density " << terrain_settings.pit_density << "\n";
+        config << "flamethrower_density " << terrain_settings.flamethrower_density << "\n";
+        config << "terrain_smoothing " << terrain_settings.smoothing << "\n";
+    }
+    if (simultaneous) config << "turn_mode simultaneous\n";
+    // Robots' rand() draws per robot; matches cached before that played differently
+    config << "robot_rand per_robot\n";
+    // Going over it disqualifies a robot
+    if (robot_memory_quota > 0) config << "robot_memory_quota " << robot_memory_quota << "\n";
+    if (stalemate_rounds > 0 || stalemate_repeats > 0) {
+        config << "stalemate_rounds " << stalemate_rounds << "\n";
+        config << "stalemate_repeats " << stalemate_repeats << "\n";
+        config << "stalemate_tiebreak " << stalemate_tiebreak << "\n";
+    }
+    return config.str();
+}
+
+template <typename Observer>
+std::string BasicArena<Observer>::match_key() const {
+    std::vector<std::pair<std::string, std::string>> libraries;
+    for (auto robot : robots) {
+#ifdef ROBOTWARZ_STATIC_ROBOTS
+        libraries.push_back({robot->m_name, "/proc/self/exe"});  // the robots are in the binary
+#else
+        libraries.push_back({robot->m_name, "lib" + robot->m_name + ".so"});
+#endif
+    }
+    return MatchCache::make_key(libraries, "RobotBase.o", normalized_config(), seed);
+}
+
+template <typename Observer>
+int BasicArena<Observer>::roll(int n) {
+    // A turn on a lane waits for every turn before it, so the dice come out
+    // in turn order whatever the lanes are doing
+    if (lane) partition_plan.wait_for_earlier(lane->index);
+    return static_cast<int>(rng() % n);
+}
+
+template <typename Observer>
+bool BasicArena<Observer>::in_bounds(int row, int col) const {
     return row >= 0 && row < height && col >= 0 && col < width;
 }
 
-char Arena::get_cell(int row, int col) const {
-    return in_bounds(row, col) ? grid[row][col] : '#';
+template <typename Observer>
+char BasicArena<Observer>::get_cell(int row, int col) const {
+    return in_bounds(row, col) ? grid.at(row, col) : '#';
 }
 
-void Arena::set_cell(int row, int col, char value) {
+template <typename Observer>
+void BasicArena<Observer>::set_cell(int row, int col, char value) {
     if (in_bounds(row, col)) {
-        grid[row][col] = value;
+        std::unique_lock<std::shared_mutex> lock(board_mutex, std::defer_lock);
+        if (board_shared) lock.lock();
+        char before = grid.at(row, col);
+        grid.set(row, col, value);
+        if (radar) radar->cell_changed(row, col, before, value);
+        if (broadcast) broadcast->cell_changed(row, col);
     }
 }
 
-void Arena::run() {
-    std::cout << "\n=========== starting round " << current_round << " ===========\n";
-    print_arena();
+template <typename Observer>
+void BasicArena<Observer>::play_round() {
+    for (size_t i = 0; i < robots.size(); i++) {
+        if (robots[i]->get_health() <= 0) continue;
+        lookahead[i].have_direction = false;
+        lookahead[i].planned = false;
+        take_turn(i, lookahead[i]);
+    }
+}
+
+// Same round as play_round, but a planning robot starts thinking as soon as no
+// robot still to act before it could hit it or change what its radar sees. Its
+// decision is then exactly the one it would make in turn order.
+template <typename Observer>
+void BasicArena<Observer>::play_round_think_ahead() {
+    std::vector<Lookahead>& ahead = lookahead;
+    for (auto& a : ahead) {
+        a.have_direction = false;
+        a.planned = false;
+    }
     
-    for (current_round = 0; current_round < max_rounds; current_round++) {
-        std::cout << "\n=========== Round " << current_round + 1 << " ===========\n";
+    for (size_t k = 0; k < robots.size(); k++) {
+        if (robots[k]->get_health() <= 0) continue;
         
-        for (auto robot : robots) {
-            if (robot->get_health() <= 0) continue;
-            
-            std::cout << "\n" << robot->m_name << " " << robot->m_character << " begins turn.\n";
-            print_robot_stats(robot, robot->m_character);
-            
+        for (size_t j = k + 1; j < robots.size(); j++) {
+            if (planners[j] && !ahead[j].planned && robots[j]->get_health() > 0) {
+                start_thinking(k, j, ahead[j]);
+            }
+        }
+        
+        take_turn(k, ahead[k]);
+    }
+    
+    // Plans of robots that never got their turn still reference this round's radar
+    for (auto& a : ahead) {
+        if (a.plan.valid()) a.plan.wait();
+    }
+}
+
+// Start robot `index` planning now if none of the living robots from `first`
+// up to it can disturb it.
+template <typename Observer>
+void BasicArena<Observer>::start_thinking(size_t first, size_t index, Lookahead& ahead) {
+    RobotBase* robot = robots[index];
+    for (size_t m = first; m < index; m++) {
+        if (robots[m]->get_health() > 0 && can_damage(robots[m], robot)) return;
+    }
+    
+    if (!ahead.have_direction) {
+        PhaseTimer timer(stats, Phase::robot);
+        TraceSpan span("get_radar_direction", robot->m_name);
+        RobotMemoryScope memory(memory_slots[index]);
+        RobotRandomScope random(&robot_random[index]);
+        try {
+            robot->get_radar_direction(ahead.radar_dir);
+        } catch (const std::bad_alloc&) {
+            return;  // over its quota; take_turn disqualifies it
+        }
+        ahead.have_direction = true;
+    }
+    for (size_t m = first; m < index; m++) {
+        if (robots[m]->get_health() > 0 && can_disturb_beam(robots[m], robot, ahead.radar_dir)) return;
+    }
+    
+    scan_radar(robot, ahead.radar_dir, ahead.radar_results);
+    TurnPlanner* planner = planners[index];
+    const std::vector<RadarObj>& radar_results = ahead.radar_results;
+    const std::string& name = robot->m_name;
+    int slot = memory_slots[index];
+    RobotRandom* stream = &robot_random[index];
+    ahead.plan = planner_pool->submit([planner, &radar_results, &name, slot, stream] {
+        TraceSpan span("plan_turn", name);
+        RobotMemoryScope memory(slot);
+        RobotRandomScope random(stream);
+        return planner->plan_turn(radar_results);
+    });
+    ahead.planned = true;
+}
+
+// Same round as play_round, with the turns spread over lanes. A turn starts
+// once every earlier turn whose zone overlaps its own is done
+// (TurnPartition.h), so each robot finds the board as it would in turn order;
+// turns far apart run side by side. Robots roll their own rand() streams
+// (RobotRandom.h), so which lane gets there first changes nothing.
+// Commentary and the decision log go out in turn order as the turns before
+// them finish.
+template <typename Observer>
+void BasicArena<Observer>::play_round_partitioned() {
+    // Events go out as they happen, so an observed arena keeps to turn order
+    if (observes_events<Observer> || partition_threads == 1) {
+        play_round();
+        return;
+    }
+    if (lanes.empty()) {
+        if (!planner_pool) {
+            int threads = partition_threads > 0 ? partition_threads
+                                                : (int)std::max(1u, std::thread::hardware_concurrency());
+            planner_pool = std::make_unique<WorkerPool>(threads);
+        }
+        // Every lane needs a thread of its own: one may be waiting on another
+        for (int i = 0; i < planner_pool->size(); i++) {
+            lanes.push_back(std::make_unique<Lane>());
+            lanes.back()->console.setstate(console.rdstate());
+        }
+        lane_turns.resize(robots.size());
+    }
+    
+    std::vector<TurnPartition::Zone> zones(robots.size());
+    for (size_t i = 0; i < robots.size(); i++) {
+        RobotBase* robot = robots[i];
+        if (robot->get_health() <= 0) continue;
+        TurnPartition::Zone& zone = zones[i];
+        zone.active = true;
+        robot->get_current_location(zone.row, zone.col);
+        zone.speed = robot->get_move_speed();
+        zone.anywhere = robot->get_weapon() == grenade;
+        lookahead[i].have_direction = false;
+        lookahead[i].planned = false;
+    }
+    partition_plan.plan(height, width, zones);
+    partition_plan.start(static_cast<int>(lanes.size()));
+    
+    board_shared = true;
+    std::vector<std::future<void>> running;
+    for (auto& own : lanes) {
+        Lane* resolving = own.get();
+        running.push_back(planner_pool->submit([this, resolving] { resolve_lane(*resolving); }));
+    }
+    for (auto& done : running) done.get();
+    board_shared = false;
+    
+    for (auto& own : lanes) {
+        stats.add(own->stats);
+        own->stats = EngineStats();
+        if (own->damage) {
+            last_damage_round = current_round + 1;
+            recent_count = recent_next = 0;
+            own->damage = false;
+        }
+    }
+    for (auto& own : lanes) {
+        if (std::exception_ptr error = std::exchange(own->error, nullptr)) std::rethrow_exception(error);
+    }
+}
+
+template <typename Observer>
+void BasicArena<Observer>::resolve_lane(Lane& own) {
+    lane = &own;
+    size_t index;
+    while (partition_plan.take(index)) {
+        own.index = index;
+        if (robots[index]->get_health() > 0) {  // not killed earlier this round
+            try {
+                take_turn(index, lookahead[index]);
+            } catch (...) {
+                // Finish the turn anyway; the lanes waiting on it would never stop
+                if (!own.error) own.error = std::current_exception();
+            }
+        }
+        lane_turns[index].commentary = own.console.str();
+        own.console.str("");
+        partition_plan.finish(index, [this](size_t i) { flush_lane_turn(i); });
+    }
+    lane = nullptr;
+}
+
+// Turn `index` and every turn before it are done
+template <typename Observer>
+void BasicArena<Observer>::flush_lane_turn(size_t index) {
+    LaneTurn& turn = lane_turns[index];
+    console << turn.commentary;
+    if (turn.disqualified) decision_log->disqualified();
+    else if (turn.logged) decision_log->turn(lookahead[index].radar_dir, turn.plan);
+    turn = LaneTurn();
+}
+
+// Every living robot decides on the board as the round found it, the robots'
+// calls side by side on the worker pool, and then all the decisions are
+// carried out together. Shots go first, from where the robots stood, and all of
+// them land - two robots can destroy each other - then the survivors move
+// (resolve_moves). Each robot's rand() draws come from its own stream
+// (RobotRandom.h), so a seed gives the same match with any thread count.
+template <typename Observer>
+void BasicArena<Observer>::play_round_simultaneous() {
+    TraceSpan span("simultaneous_round");
+    if (!planner_pool && !replay_log && turn_threads != 1) {
+        int threads = turn_threads > 0 ? turn_threads : (int)std::max(1u, std::thread::hardware_concurrency());
+        planner_pool = std::make_unique<WorkerPool>(threads);
+    }
+    beam_packers.resize(robots.size());
+    
+    enum : char { acts, disqualified, skipped };
+    std::vector<size_t> acting;
+    for (size_t i = 0; i < robots.size(); i++) {
+        if (robots[i]->get_health() > 0) acting.push_back(i);
+    }
+    std::vector<TurnPlan> plans(robots.size());
+    std::vector<char> status(robots.size(), acts);
+    auto runs_robot_code = [this](size_t index) { return !replay_log && index >= static_cast<size_t>(learner_count); };
+    
+    // job(index) for every robot still acting that decides for itself, all at once
+    auto call_robots = [&](auto job) {
+        std::vector<std::future<void>> pending;
+        for (size_t index : acting) {
+            if (!runs_robot_code(index) || status[index] != acts) continue;
+            auto call = [&, index] {
+                RobotMemoryScope memory(memory_slots[index]);
+                RobotRandomScope random(&robot_random[index]);
+                try {
+                    job(index);
+                } catch (const std::bad_alloc&) {
+                    status[index] = disqualified;
+                }
+            };
+            if (planner_pool) pending.push_back(planner_pool->submit(call));
+            else call();
+        }
+        for (auto& call : pending) call.get();
+    };
+    
+    {
+        PhaseTimer timer(stats, Phase::robot);
+        call_robots([this](size_t index) {
+            TraceSpan span("get_radar_direction", robots[index]->m_name);
+            robots[index]->get_radar_direction(lookahead[index].radar_dir);
+        });
+    }
+    
+    // Everyone scans the same board
+    for (size_t index : acting) {
+        RobotBase* robot = robots[index];
+        Lookahead& ahead = lookahead[index];
+        turn_memory.reset();
+        stats.robot_turns++;
+        if constexpr (observes_events<Observer>) observer.turn_start({current_round + 1, robot});
+        console << "\n" << robot->m_name << " " << robot->m_character << " decides.\n";
+        print_robot_stats(robot, robot->m_character);
+        
+        if (replay_log) {
+            if (replay_log->next_disqualified()) {
+                status[index] = disqualified;
+            } else if (replay_diverged || !replay_log->next_turn(ahead.radar_dir, plans[index])) {
+                replay_diverged = true;
+                status[index] = skipped;
+            }
+        } else if (index < static_cast<size_t>(learner_count)) {
+            learner_turn(index, ahead, plans[index]);
+        }
+        if (status[index] != acts) continue;
+        scan_radar(robot, ahead.radar_dir, ahead.radar_results);
+        report_radar(robot, ahead.radar_dir, ahead.radar_results);
+    }
+    
+    {
+        PhaseTimer timer(stats, Phase::robot);
+        call_robots([this, &plans](size_t index) {
+            plans[index] = decide(index, lookahead[index].radar_results, beam_packers[index]);
+        });
+    }
+    
+    // Out of the round before anything lands: over quota, then every turn in robot order
+    console << "\n";
+    for (size_t index : acting) {
+        if (status[index] == acts && runs_robot_code(index) && RobotMemory::over_quota(memory_slots[index])) {
+            status[index] = disqualified;
+        }
+        if (status[index] == disqualified) disqualify(index);
+        else if (status[index] == acts && decision_log) decision_log->turn(lookahead[index].radar_dir, plans[index]);
+    }
+    
+    std::vector<size_t> movers;
+    for (size_t index : acting) {
+        if (status[index] != acts) continue;
+        RobotBase* robot = robots[index];
+        const TurnPlan& plan = plans[index];
+        if (plan.shoot) {
+            console << robot->m_name << " " << robot->m_character << ":";
+            handle_shot(robot, plan.shot_row, plan.shot_col);
+        } else if (plan.move_distance > 0) {
+            movers.push_back(index);
+        } else {
+            console << robot->m_name << " " << robot->m_character << ":  not firing, not moving\n";
+        }
+    }
+    resolve_moves(movers, plans);
+}
+
+// The moves of a simultaneous round. Every path is walked on the board the
+// shots left: the edge, mounds and robots where they stood stop a robot, and a
+// pit swallows it. Robots whose paths end on the same cell each stop one cell
+// short, again until every robot ends alone - so a pit takes at most one, and
+// a robot that stopped short of a pit never fell in. Then each robot, in order,
+// burns in the flames its path still crosses and moves.
+template <typename Observer>
+void BasicArena<Observer>::resolve_moves(const std::vector<size_t>& movers, const std::vector<TurnPlan>& plans) {
+    PhaseTimer timer(stats, Phase::move);
+    TraceSpan span("resolve_moves");
+    struct Step {
+        int row;
+        int col;
+        char cell;
+    };
+    std::vector<size_t> moving;
+    std::vector<std::vector<Step>> paths;
+    for (size_t index : movers) {
+        RobotBase* robot = robots[index];
+        if (robot->get_health() <= 0) continue;  // destroyed by this round's shots
+        stats.moves++;
+        const TurnPlan& plan = plans[index];
+        std::vector<Step> path;
+        if (plan.move_direction >= 1 && plan.move_direction <= 8) {
+            auto [dr, dc] = directions[plan.move_direction];
+            int row, col;
+            robot->get_current_location(row, col);
+            int distance = std::min(plan.move_distance, robot->get_move_speed());
+            for (int step = 0; step < distance; step++) {
+                row += dr;
+                col += dc;
+                if (!in_bounds(row, col)) break;
+                char cell = grid.at(row, col);
+                if (cell == 'M' || cell == 'R') break;
+                path.push_back({row, col, cell});
+                if (cell == 'P') break;
+            }
+        }
+        moving.push_back(index);
+        paths.push_back(std::move(path));
+    }
+    
+    for (bool contested = true; contested;) {
+        std::map<std::pair<int, int>, int> ends;
+        for (const auto& path : paths) {
+            if (!path.empty()) ends[{path.back().row, path.back().col}]++;
+        }
+        contested = false;
+        for (auto& path : paths) {
+            if (!path.empty() && ends[{path.back().row, path.back().col}] > 1) {
+                path.pop_back();
+                contested = true;
+            }
+        }
+    }
+    
+    for (size_t k = 0; k < moving.size(); k++) {
+        RobotBase* robot = robots[moving[k]];
+        const std::vector<Step>& path = paths[k];
+        console << robot->m_name << " " << robot->m_character << ":  moving";
+        if (path.empty()) {
+            console << "  not moving\n";
+            continue;
+        }
+        for (const Step& step : path) {
+            if (step.cell == 'F') burn(robot, step.row, step.col);
+            else if (step.cell == 'P') fall_in_pit(robot, step.row, step.col);
+        }
+        int from_row, from_col;
+        robot->get_current_location(from_row, from_col);
+        const Step& end = path.back();
+        set_cell(from_row, from_col, '.');
+        set_cell(end.row, end.col, 'R');
+        robot->move_to(end.row, end.col);
+        stats_of(robot).distance_moved += std::max(std::abs(end.row - from_row), std::abs(end.col - from_col));
+        if constexpr (observes_events<Observer>) {
+            observer.move({current_round + 1, robot, from_row, from_col, end.row, end.col});
+        }
+        console << "  moving to (" << end.row << "," << end.col << ")\n";
+    }
+}
+
+template <typename Observer>
+void BasicArena<Observer>::take_turn(size_t index, Lookahead& ahead) {
+    RobotBase* robot = robots[index];
+    TraceSpan span("turn", robot->m_name);
+    turn_scratch().reset();
+    turn_stats().robot_turns++;
+    if constexpr (observes_events<Observer>) observer.turn_start({current_round + 1, robot});
+    
+    commentary() << "\n" << robot->m_name << " " << robot->m_character << " begins turn.\n";
+    print_robot_stats(robot, robot->m_character);
+    
+    TurnPlan plan;
+    bool out_of_memory = false;
+    if (replay_log) {
+        // The recorded answers stand in for the robot's
+        if (replay_log->next_disqualified()) {
+            disqualify(index);
+            return;
+        }
+        if (replay_diverged || !replay_log->next_turn(ahead.radar_dir, plan)) {
+            replay_diverged = true;
+            return;
+        }
+        scan_radar(robot, ahead.radar_dir, ahead.radar_results);
+        report_radar(robot, ahead.radar_dir, ahead.radar_results);
+    } else if (index < static_cast<size_t>(learner_count)) {
+        learner_turn(index, ahead, plan);
+        scan_radar(robot, ahead.radar_dir, ahead.radar_results);
+        report_radar(robot, ahead.radar_dir, ahead.radar_results);
+    } else if (ahead.planned) {
+        report_radar(robot, ahead.radar_dir, ahead.radar_results);
+        PhaseTimer timer(turn_stats(), Phase::robot);
+        TraceSpan wait("wait_for_plan", robot->m_name);
+        try {
+            plan = ahead.plan.get();
+        } catch (const std::bad_alloc&) {
+            out_of_memory = true;
+        }
+    } else {
+        try {
             // Radar
-            int radar_dir;
-            robot->get_radar_direction(radar_dir);
-            std::vector<RadarObj> radar_results = scan_radar(robot, radar_dir);
-            
-            std::cout << "  checking radar ... ";
-            if (radar_results.empty()) {
-                std::cout << " found nothing.\n";
-            } else {
-                std::cout << " found '" << radar_results[0].m_type << "' at (" 
-                          << radar_results[0].m_row << "," << radar_results[0].m_col << ")\n";
+            if (!ahead.have_direction) {
+                PhaseTimer timer(turn_stats(), Phase::robot);
+                TraceSpan span("get_radar_direction", robot->m_name);
+                RobotMemoryScope memory(memory_slots[index]);
+                RobotRandomScope random(&robot_random[index]);
+                robot->get_radar_direction(ahead.radar_dir);
             }
-            
-            robot->process_radar_results(radar_results);
-            
-            // Shoot or move
-            int shot_row, shot_col;
-            if (robot->get_shot_location(shot_row, shot_col)) {
-                handle_shot(robot, shot_row, shot_col);
+            scan_radar(robot, ahead.radar_dir, ahead.radar_results);
+            report_radar(robot, ahead.radar_dir, ahead.radar_results);
+            PhaseTimer timer(turn_stats(), Phase::robot);
+            plan = decide(index, ahead.radar_results, lane ? lane->beam_packer : beam_packer);
+        } catch (const std::bad_alloc&) {
+            out_of_memory = true;
+        }
+    }
+    
+    // A robot may catch the bad_alloc itself; the slot still remembers
+    if (out_of_memory || RobotMemory::over_quota(memory_slots[index])) {
+        disqualify(index);
+        return;
+    }
+    
+    if (decision_log && lane) {
+        lane_turns[index].logged = true;
+        lane_turns[index].plan = plan;
+    } else if (decision_log) {
+        decision_log->turn(ahead.radar_dir, plan);
+    }
+    carry_out(robot, plan);
+}
+
+// Played from outside; a learner given no turn stays put
+template <typename Observer>
+void BasicArena<Observer>::learner_turn(size_t index, Lookahead& ahead, TurnPlan& plan) {
+    RobotBase* robot = robots[index];
+    if (learner_turns) {
+        ahead.radar_dir = learner_turns[index].radar_dir;
+        plan = learner_turns[index].plan;
+    }
+    // Only turns a robot could have taken: no grenades out of thin air,
+    // no moves in a direction that isn't one
+    if (plan.shoot && robot->get_weapon() == grenade && robot->get_grenades() <= 0) plan.shoot = false;
+    if (plan.move_direction < 1 || plan.move_direction > 8) plan.move_distance = 0;
+}
+
+template <typename Observer>
+void BasicArena<Observer>::report_radar(RobotBase* robot, int direction, const std::vector<RadarObj>& radar_results) {
+    if constexpr (observes_events<Observer>) observer.radar_scan({current_round + 1, robot, direction, radar_results});
+    commentary() << "  checking radar ... ";
+    if (radar_results.empty()) {
+        commentary() << " found nothing.\n";
+    } else {
+        commentary() << " found '" << radar_results[0].m_type << "' at (" 
+                  << radar_results[0].m_row << "," << radar_results[0].m_col << ")\n";
+    }
+}
+
+template <typename Observer>
+TurnPlan BasicArena<Observer>::decide(size_t index, const std::vector<RadarObj>& radar_results,
+                                      RadarBeamPacker& packer) {
+    RobotMemoryScope memory(memory_slots[index]);
+    RobotRandomScope random(&robot_random[index]);
+    RobotBase* robot = robots[index];
+    if (planners[index]) {
+        TraceSpan span("plan_turn", robot->m_name);
+        return planners[index]->plan_turn(radar_results);
+    }
+    
+    TurnPlan plan;
+    if (beam_receivers[index]) {
+        int row, col;
+        robot->get_current_location(row, col);
+        const RadarBeam& beam = packer.pack(height, width, row, col, lookahead[index].radar_dir, radar_results);
+        TraceSpan span("process_radar_beam", robot->m_name);
+        beam_receivers[index]->process_radar_beam(beam);
+    } else {
+        TraceSpan span("process_radar_results", robot->m_name);
+        robot->process_radar_results(radar_results);
+    }
+    {
+        TraceSpan span("get_shot_location", robot->m_name);
+        plan.shoot = robot->get_shot_location(plan.shot_row, plan.shot_col);
+    }
+    if (!plan.shoot) {
+        TraceSpan span("get_move_direction", robot->m_name);
+        robot->get_move_direction(plan.move_direction, plan.move_distance);
+    }
+    return plan;
+}
+
+// Over its memory quota: out of the match, as if destroyed
+template <typename Observer>
+void BasicArena<Observer>::disqualify(size_t index) {
+    RobotBase* robot = robots[index];
+    int slot = memory_slots[index];
+    commentary() << "  " << robot->m_name << " is disqualified for using too much memory";
+    if (!replay_log) {
+        commentary() << " (" << RobotMemory::peak_bytes(slot) << " bytes, quota " << RobotMemory::quota(slot) << ")";
+    }
+    commentary() << "\n";
+    robot->take_damage(robot->get_health());
+    stats_of(robot).rounds_survived = current_round;
+    if constexpr (observes_events<Observer>) observer.death({current_round + 1, robot, nullptr});
+    if (decision_log && lane) lane_turns[index].disqualified = true;
+    else if (decision_log) decision_log->disqualified();
+}
+
+// Shoot or move
+template <typename Observer>
+void BasicArena<Observer>::carry_out(RobotBase* robot, const TurnPlan& plan) {
+    if (plan.shoot) {
+        handle_shot(robot, plan.shot_row, plan.shot_col);
+    } else if (plan.move_distance > 0) {
+        commentary() << "  moving";
+        handle_movement(robot, plan.move_direction, plan.move_distance);
+    } else {
+        commentary() << "  not firing, not moving\n";
+    }
+}
+
+// Could actor's shot this turn land on target's cell, whatever it aims at?
+template <typename Observer>
+bool BasicArena<Observer>::can_damage(RobotBase* actor, RobotBase* target) {
+    int ar, ac, tr, tc;
+    actor->get_current_location(ar, ac);
+    target->get_current_location(tr, tc);
+    int dr = std::abs(tr - ar);
+    int dc = std::abs(tc - ac);
+    
+    switch (actor->get_weapon()) {
+        case railgun:      return dr == 0 || dc == 0 || dr == dc;
+        case grenade:      return true;
+        case hammer:       return std::max(dr, dc) <= 1;
+        case flamethrower: return std::max(dr, dc) <= flamethrower_range + 1;
+    }
+    return true;
+}
+
+// Could actor's move this turn change a cell in target's radar beam? Uses a
+// slight superset of the beam so it holds for every beam shape.
+template <typename Observer>
+bool BasicArena<Observer>::can_disturb_beam(RobotBase* actor, RobotBase* target, int radar_dir) {
+    int speed = actor->get_move_speed();
+    if (speed <= 0) return false;
+    if (radar_dir < 0 || radar_dir > 8) return false;
+    
+    int ar, ac, tr, tc;
+    actor->get_current_location(ar, ac);
+    target->get_current_location(tr, tc);
+    auto [dr, dc] = directions[radar_dir];
+    
+    for (int r = std::max(0, ar - speed); r <= std::min(height - 1, ar + speed); r++) {
+        for (int c = std::max(0, ac - speed); c <= std::min(width - 1, ac + speed); c++) {
+            int a = r - tr;
+            int b = c - tc;
+            bool in_beam;
+            if (radar_dir == 0) {
+                in_beam = std::max(std::abs(a), std::abs(b)) == 1;
+            } else if (dc == 0) {
+                in_beam = a * dr >= 1 && std::abs(b) <= 1;
+            } else if (dr == 0) {
+                in_beam = b * dc >= 1 && std::abs(a) <= 1;
             } else {
-                int move_dir, move_dist;
-                robot->get_move_direction(move_dir, move_dist);
-                if (move_dist > 0) {
-                    std::cout << "  moving";
-                    handle_movement(robot, move_dir, move_dist);
-                } else {
-                    std::cout << "  not firing, not moving\n";
-                }
+                int ta = a * dr, tb = b * dc;
+                in_beam = std::abs(ta - tb) <= 1 && std::min(ta, tb) >= 0 && std::max(ta, tb) >= 1;
+            }
+            if (in_beam) return true;
+        }
+    }
+    return false;
+}
+
+template <typename Observer>
+void BasicArena<Observer>::export_stats() {
+    stats.robot_heap.clear();
+    for (size_t i = 0; i < robots.size(); i++) {
+        if (memory_slots[i] == 0) continue;  // untracked
+        stats.robot_heap.push_back({robots[i]->m_name, RobotMemory::current_bytes(memory_slots[i]),
+                                    RobotMemory::peak_bytes(memory_slots[i])});
+    }
+    if (!stats_file.empty()) {
+        stats.write_files(stats_file);
+    }
+}
+
+template <typename Observer>
+void BasicArena<Observer>::add_learners(int count, int move, int armor, WeaponType weapon) {
+    learner_count = count;
+    learner_stats = {"", move, armor, weapon};
+}
+
+template <typename Observer>
+bool BasicArena<Observer>::step(const LearnerTurn* turns) {
+    if (result.outcome != "unfinished") return false;
+    
+    stats.rounds++;
+    learner_turns = turns;
+    if (simultaneous) {
+        play_round_simultaneous();
+    } else if (partition) {
+        play_round_partitioned();
+    } else {
+        play_round();
+    }
+    learner_turns = nullptr;
+    if constexpr (observes_events<Observer>) end_round_event();
+    
+    bool over = check_winner() || check_stalemate();
+    if (!over && current_round + 1 >= max_rounds) {
+        result.outcome = "max_rounds";
+        over = true;
+    }
+    if (over) record_robot_results();
+    current_round++;
+    return !over;
+}
+
+template <typename Observer>
+void BasicArena<Observer>::run() {
+    // A seeded match with nothing changed since it last ran has a known outcome
+    open_decision_log();
+    std::string cache_key;
+    if (!match_cache_dir.empty() && seed_from_config && !decision_log && !replay_log) {
+        cache_key = match_key();
+        if (MatchCache(match_cache_dir).lookup(cache_key, result)) {
+            console << "\nMatch " << cache_key << " found in cache (" << result.rounds << " rounds).\n";
+            for (const auto& robot : result.robots) {
+                console << robot.name << " Health: " << robot.health << " Armor: " << robot.armor << "\n";
             }
+            print_result();
+            // A rerun of a cached match is still a match played for the store
+            if (!analytics_file.empty()) {
+                AnalyticsWriter(analytics_file).append(0, seed, result);
+            }
+            return;
+        }
+    }
+    
+    if (think_ahead && !simultaneous && !partition && std::count(planners.begin(), planners.end(), nullptr) < (long)planners.size()) {
+        int threads = think_ahead_threads > 0 ? think_ahead_threads
+                                              : (int)std::max(1u, std::thread::hardware_concurrency());
+        planner_pool = std::make_unique<WorkerPool>(threads);
+    }
+    
+    stats.start_clock();
+    console << "\n=========== starting round " << current_round << " ===========\n";
+    print_arena();
+    
+    if (!broadcast_path.empty()) {
+        broadcast = std::make_unique<SpectatorBroadcast>();
+        if (broadcast->open(broadcast_path)) {
+            console << "Broadcasting on " << broadcast_path << " (watch with RobotWarz --watch " << broadcast_path << ")\n";
+            publish_round(0);
+        } else {
+            broadcast.reset();
         }
+    }
+    
+    for (current_round = 0; current_round < max_rounds; current_round++) {
+        TraceSpan round_span("round");
+        console << "\n=========== Round " << current_round + 1 << " ===========\n";
+        stats.rounds++;
+        
+        if (simultaneous) {
+            play_round_simultaneous();
+        } else if (partition && !replay_log) {
+            play_round_partitioned();
+        } else if (think_ahead && planner_pool) {
+            play_round_think_ahead();
+        } else {
+            play_round();
+        }
+        if constexpr (observes_events<Observer>) end_round_event();
         
         if (watch_live) {
             print_arena();
             sleep(1);
         }
+        if (broadcast) publish_round(current_round + 1);
+        
+        if ((current_round + 1) % stats_interval == 0) {
+            export_stats();
+        }
+        
+        if (decision_log) decision_log->end_round(state_checksum());
+        if (replay_log && !check_replay_round()) break;
         
-        if (check_winner()) break;
+        if (check_winner() || check_stalemate()) break;
     }
     
     if (current_round >= max_rounds) {
-        std::cout << "\n\nMax rounds reached. Game over.\n";
+        result.outcome = "max_rounds";
+        print_result();
+    }
+    record_robot_results();
+    if (broadcast) {
+        std::ostringstream line;
+        if (result.outcome == "winner") line << "WINNER: " << result.winner;
+        else if (result.outcome == "no_survivors") line << "NO SURVIVORS";
+        else if (result.outcome == "stalemate" && result.winner.empty()) line << "STALEMATE, draw";
+        else if (result.outcome == "stalemate") line << "STALEMATE, WINNER on " << stalemate_tiebreak << ": " << result.winner;
+        else line << "Max rounds reached";
+        line << " after " << result.rounds << " rounds";
+        broadcast->finish(result.rounds, line.str());
+        broadcast.reset();
+    }
+    
+    print_robot_memory();
+    
+    if (replay_log && !replay_diverged) {
+        console << "\nReplay matches the recording through round " << result.rounds << ".\n";
     }
+    
+    if (!cache_key.empty()) {
+        MatchCache(match_cache_dir).store(cache_key, result);
+    }
+    if (!analytics_file.empty()) {
+        AnalyticsWriter(analytics_file).append(0, seed, result);
+    }
+    
+    export_stats();
 }
+
+// Every arena the program uses. A compile-time observer gets its own line here.
+template class BasicArena<NullObserver>;
+template class BasicArena<DynamicObserver>;
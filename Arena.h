@@ -3,51 +3,267 @@
 
 #include "RobotBase.h"
 #include "RadarObj.h"
+#include "RobotPlanner.h"
+#include "WorkerPool.h"
+#include "EngineStats.h"
+#include "MatchResult.h"
+#include "ArenaGrid.h"
+#include "MapFile.h"
+#include "MapGenerator.h"
+#include "RadarEngine.h"
+#include "TurnMemory.h"
+#include "DecisionLog.h"
+#include "Spectator.h"
+#include "MatchObserver.h"
+#include "RobotLibrary.h"
+#include "TurnPartition.h"
+#include "RobotRandom.h"
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <memory>
+#include <random>
+#include <future>
+#include <shared_mutex>
+#include <sstream>
+#include <istream>
+#include <ostream>
 
-class Arena {
+// The arena, with the observer policy its engine events go to (MatchObserver.h).
+// Instantiated in Arena.cpp for the observers listed there.
+template <typename Observer = NullObserver>
+class BasicArena {
 private:
+    mutable std::ostream console;         // Match commentary: std::cout, or nothing with "quiet yes"
     int width;
     int height;
     int max_rounds;
     bool watch_live;
     int current_round;
+    int num_mounds;
+    int num_pits;
+    int num_flamethrowers;
     
-    std::vector<std::vector<char>> grid;  // The arena board
+    unsigned seed;                        // Seeds every random choice the arena makes
+    bool seed_from_config;                // false = seeded from the clock
+    std::mt19937 rng;
+    std::string radar_engine;             // "auto", "dense" or "sparse"
+    std::string match_cache_dir;          // Directory of cached match results, empty = off
+    std::vector<std::string> roster;      // Robots to load by name, empty = every Robot_*.cpp
+    MatchResult result;
+    
+    int stalemate_rounds = 0;             // End the match after this many rounds without damage, 0 = never
+    int stalemate_repeats = 0;            // ... or when a position comes round this many times, 0 = never
+    std::string stalemate_tiebreak = "health";  // Who wins a stalemate: "health", "health_armor" or "draw"
+    int last_damage_round = 0;            // Round anyone last took damage, from 1; 0 = not yet
+    // Since then: robot position hashes, in a ring sized once per match - the
+    // last stalemate_rounds of them, which is every one since the damage, or
+    // the last position_window when that check is off
+    static constexpr size_t position_window = 1024;
+    std::vector<uint64_t> recent_positions;
+    size_t recent_count = 0;              // filled entries
+    size_t recent_next = 0;               // where the next hash goes
+    std::string stalemate_reason;         // Why the match was called, for the result line
+    
+    EngineStats stats;                    // Counters and phase timers
+    std::string stats_file;               // Base name for .prom/.json export, empty = off
+    int stats_interval;                   // Export every N rounds
+    
+    ArenaGrid grid;                       // The arena board
+    std::string map_file;                 // Scenario map to play on, empty = random board
+    std::vector<SpawnPoint> spawn_points; // From the map; robots are placed here first
+    bool terrain = false;                 // Generate the board procedurally instead of placing obstacles
+    TerrainSettings terrain_settings;     // Densities for the generator; its seed is the match seed
+    std::unique_ptr<RadarEngine> radar;   // Answers radar scans over grid
     std::vector<RobotBase*> robots;       // All robots
-    std::vector<void*> robot_handles;     // For dlopen/dlclose
+    std::vector<RobotLibraries::Ref> robot_libraries;  // Parallel to robots; keeps their code loaded, null for stand-ins
     std::map<RobotBase*, char> robot_symbols;  // Robot display characters
+    std::unordered_map<RobotBase*, size_t> robot_index;  // Position in robots, for stats_of
+    std::vector<int> memory_slots;        // Parallel to robots; RobotMemory accounting slot
+    std::vector<RobotRandom> robot_random;  // Parallel to robots; their rand() streams
+    int64_t robot_memory_quota = 0;       // Heap bytes a robot may hold, 0 = unlimited
+    std::vector<MatchResult::RobotStats> robot_stats;  // Parallel to robots; what each did this match
+    std::string analytics_file;           // Columnar store for per-robot match stats, empty = off
+    std::string broadcast_path;           // Unix socket to broadcast the match on, empty = off
+    int broadcast_delay = 0;              // ms to pause after each broadcast round
+    std::unique_ptr<SpectatorBroadcast> broadcast;
+    std::vector<TurnPlanner*> planners;   // Parallel to robots; null if the robot doesn't plan
+    std::vector<RadarBeamReceiver*> beam_receivers;  // Parallel to robots; null if it takes RadarObj vectors
+    RadarBeamPacker beam_packer;
+    
+    bool think_ahead;                     // Let planning robots think during other turns
+    int think_ahead_threads;
+    bool simultaneous = false;            // turn_mode simultaneous: all decide on one board, then all act
+    int turn_threads = 0;                 // Robots deciding at once in a simultaneous round, 0 = one per core
+    std::unique_ptr<WorkerPool> planner_pool;  // Thinking ahead, simultaneous rounds, or partitioned ones
+    std::vector<RadarBeamPacker> beam_packers; // One per robot for simultaneous rounds
+    bool partition = false;               // Resolve turns that can't affect each other side by side
+    int partition_threads = 0;            // Lanes for that, 0 = one per core, 1 = plain turn order
+    TurnPartition partition_plan;         // This round's overlapping turns and their schedule
+    std::shared_mutex board_mutex;        // Cells and radar index, while lanes share them
+    bool board_shared = false;
+    
+    // A thread resolving turns of a partitioned round. Commentary, counters
+    // and scratch are its own, and go to the arena's in turn order.
+    struct Lane {
+        size_t index = 0;                 // The turn being resolved
+        std::ostringstream console;
+        EngineStats stats;
+        TurnMemory memory;
+        RadarBeamPacker beam_packer;
+        bool damage = false;              // Someone took damage on this lane this round
+        std::exception_ptr error;         // Thrown out of a robot's turn; rethrown after the round
+    };
+    std::vector<std::unique_ptr<Lane>> lanes;
+    static thread_local Lane* lane;       // The lane on this thread, if any
+    
+    // What a partitioned turn leaves for the console and decision log
+    struct LaneTurn {
+        std::string commentary;
+        bool logged = false;
+        bool disqualified = false;
+        TurnPlan plan;
+    };
+    std::vector<LaneTurn> lane_turns;     // One per robot
+    
+    // A planning robot's turn, possibly started before the robot is up
+    struct Lookahead {
+        bool have_direction = false;
+        int radar_dir = 0;
+        bool planned = false;
+        std::vector<RadarObj> radar_results;
+        std::future<TurnPlan> plan;
+    };
+    std::vector<Lookahead> lookahead;     // One per robot, reused every round
+    
+    std::string record_path;              // Decision log to write, empty = off
+    std::unique_ptr<DecisionLogWriter> decision_log;
+    std::unique_ptr<DecisionLogReader> replay_log;   // Set when replaying a recorded match
+    std::vector<DecisionLogHeader::Robot> replay_robots;
+    bool replay_diverged = false;
+    
+public:
+    // A learner's turn, decided outside the arena (see step)
+    struct LearnerTurn {
+        int radar_dir = 0;
+        TurnPlan plan;
+    };
+    
+private:
+    int learner_count = 0;                // Robots 0..learner_count-1 are learners
+    DecisionLogHeader::Robot learner_stats;
+    const LearnerTurn* learner_turns = nullptr;  // This round's, while step() plays it
+    TurnMemory turn_memory;               // Scratch for the turn being resolved
+    [[no_unique_address]] Observer observer;
     
     // Helper functions
-    void load_config(const std::string& config_file);
+    void load_config(std::istream& config);
     void place_obstacles(int num_mounds, int num_pits, int num_flamethrowers);
+    bool set_up_match();  // false if the map cannot be loaded
     void load_robots();
-    void compile_robot(const std::string& cpp_file);
-    RobotBase* load_robot_library(const std::string& so_file, void*& handle);
+    void add_robot(RobotBase* robot, const std::string& robot_name, RobotLibraries::Ref library,
+                   TurnPlanner* planner, RadarBeamReceiver* beam_receiver, int slot);
     void place_robot(RobotBase* robot, char symbol);
     
     // Game loop helpers
     void print_arena();
     void print_robot_stats(RobotBase* robot, char symbol);
-    std::vector<RadarObj> scan_radar(RobotBase* robot, int direction);
+    void play_round();
+    void play_round_think_ahead();
+    void take_turn(size_t index, Lookahead& ahead);
+    void start_thinking(size_t first, size_t index, Lookahead& ahead);
+    void report_radar(RobotBase* robot, int direction, const std::vector<RadarObj>& radar_results);
+    void play_round_simultaneous();
+    void play_round_partitioned();
+    void resolve_lane(Lane& own);
+    void flush_lane_turn(size_t index);
+    void resolve_moves(const std::vector<size_t>& movers, const std::vector<TurnPlan>& plans);
+    void learner_turn(size_t index, Lookahead& ahead, TurnPlan& plan);
+    // Only touches the robot and `packer`, so robots can decide side by side
+    TurnPlan decide(size_t index, const std::vector<RadarObj>& radar_results, RadarBeamPacker& packer);
+    void carry_out(RobotBase* robot, const TurnPlan& plan);
+    void disqualify(size_t index);
+    bool can_damage(RobotBase* actor, RobotBase* target);
+    bool can_disturb_beam(RobotBase* actor, RobotBase* target, int radar_dir);
+    void scan_radar(RobotBase* robot, int direction, std::vector<RadarObj>& results);
+    void choose_radar_engine();
     void handle_shot(RobotBase* shooter, int shot_row, int shot_col);
+    template <WeaponType W>
+    void resolve_shot(RobotBase* shooter, int shot_row, int shot_col);
+    void hit_cell(RobotBase* shooter, WeaponType weapon, int row, int col);
     void handle_movement(RobotBase* robot, int direction, int distance);
+    void fall_in_pit(RobotBase* robot, int row, int col);
+    void burn(RobotBase* robot, int row, int col);
     int calculate_damage(WeaponType weapon);
     bool check_winner();
+    bool check_stalemate();
+    uint64_t position_hash();
+    int position_repeats();
+    void record_robot_results();
+    void publish_round(int rounds_played);
+    void end_round_event();
+    MatchResult::RobotStats& stats_of(RobotBase* robot);
+    void note_damage(RobotBase* robot, int damage);
+    void print_result() const;
+    std::string normalized_config() const;
+    std::string match_key() const;
+    void export_stats();
+    void print_robot_memory() const;
+    static int64_t parse_bytes(const std::string& value);
+    void open_decision_log();
+    bool check_replay_round();
+    uint64_t state_checksum();
+    
+    // The turn being resolved writes here: the arena's own, or its lane's
+    std::ostream& commentary() const { return lane ? lane->console : console; }
+    EngineStats& turn_stats() { return lane ? lane->stats : stats; }
+    TurnMemory& turn_scratch() { return lane ? lane->memory : turn_memory; }
     
     // Utility
+    int roll(int n);                      // random int in [0, n)
     bool in_bounds(int row, int col) const;
     char get_cell(int row, int col) const;
     void set_cell(int row, int col, char value);
     
 public:
-    Arena();
-    ~Arena();
+    BasicArena();
+    ~BasicArena();
     
-    void initialize(const std::string& config_file);
+    Observer& observers() { return observer; }
+    
+    // Both return false (having said why) if the match cannot be set up
+    bool initialize(const std::string& config_file);
+    bool initialize(std::istream& config);  // Config text in arena.config format
+    // Replay a decision log instead of running robots. The board, seed and roster
+    // come from the log; display and stats settings from config_file.
+    bool initialize_replay(const std::string& config_file, const std::string& log_file);
+    void record_decisions(const std::string& path) { record_path = path; }  // before run()
+    bool replay_matched() const { return !replay_diverged; }
     void run();
+    const MatchResult& match_result() const { return result; }
+    
+    // Stepping from outside, for training robot AIs (see BatchEnv). Learners
+    // are stand-in robots that take the first slots, ahead of the roster;
+    // instead of calling robot code the arena plays the turns step() is given.
+    void add_learners(int count, int move, int armor, WeaponType weapon);  // before initialize
+    // One round, with turns[i] for learner i. false once the match is over.
+    bool step(const LearnerTurn* turns);
+    size_t robot_count() const { return robots.size(); }
+    RobotBase* robot_at(size_t index) const { return robots[index]; }
+    // What robot `index` saw on its latest turn
+    const std::vector<RadarObj>& last_radar(size_t index) const { return lookahead[index].radar_results; }
+    int board_height() const { return height; }
+    int board_width() const { return width; }
+    int round() const { return current_round; }
 };
 
+// The headless arena: no engine events, not even their call sites
+using Arena = BasicArena<NullObserver>;
+// Engine events go to MatchObservers attached at runtime: observers().add(...)
+using ObservedArena = BasicArena<DynamicObserver>;
+
+extern template class BasicArena<NullObserver>;
+extern template class BasicArena<DynamicObserver>;
+
 #endif // ARENA_H
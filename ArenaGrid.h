@@ -0,0 +1,62 @@
+#ifndef ARENA_GRID_H
+#define ARENA_GRID_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// The arena board as one row-major block of cells, so a row is contiguous
+// memory that can be scanned in bulk. The block is normally owned by the grid;
+// adopt() plays on someone else's block instead, e.g. a memory-mapped map file.
+class ArenaGrid {
+public:
+    ArenaGrid() = default;
+    ArenaGrid(const ArenaGrid&) = delete;
+    ArenaGrid& operator=(const ArenaGrid&) = delete;
+
+    void reset(int rows, int cols, char fill = '.') {
+        height_ = rows;
+        width_ = cols;
+        external.reset();
+        storage.assign(static_cast<size_t>(rows) * cols, fill);
+        cells = storage.data();
+    }
+
+    // Use rows * cols cells at `block` as the board, without copying. `owner`
+    // keeps the block alive (and cleans it up) until the next reset or adopt.
+    void adopt(char* block, int rows, int cols, std::shared_ptr<void> owner) {
+        height_ = rows;
+        width_ = cols;
+        storage.clear();
+        storage.shrink_to_fit();
+        external = std::move(owner);
+        cells = block;
+    }
+
+    int height() const { return height_; }
+    int width() const { return width_; }
+
+    char at(int row, int col) const { return cells[index(row, col)]; }
+    void set(int row, int col, char value) { cells[index(row, col)] = value; }
+    const char* row(int r) const { return cells + index(r, 0); }
+    char* row(int r) { return cells + index(r, 0); }
+
+    // Number of non-empty cells
+    size_t count_objects() const {
+        size_t count = 0;
+        size_t total = static_cast<size_t>(height_) * width_;
+        for (size_t i = 0; i < total; i++) count += (cells[i] != '.');
+        return count;
+    }
+
+private:
+    int height_ = 0;
+    int width_ = 0;
+    char* cells = nullptr;
+    std::vector<char> storage;
+    std::shared_ptr<void> external;
+
+    size_t index(int row, int col) const { return static_cast<size_t>(row) * width_ + col; }
+};
+
+#endif // ARENA_GRID_H
@@ -0,0 +1,168 @@
+#include "BatchEnv.h"
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+BatchEnv::BatchEnv(int batch, const std::string& config_text, int learners, int threads)
+    : config(config_text), learner_count(learners), envs(std::max(batch, 1)) {
+    std::vector<std::string> roster;
+    std::istringstream settings(config);
+    std::string key, value;
+    while (settings >> key >> value) {
+        if (key == "learner_move") learner_move = std::stoi(value);
+        else if (key == "learner_armor") learner_armor = std::stoi(value);
+        else if (key == "learner_weapon") {
+            if (value == "flamethrower") learner_weapon = flamethrower;
+            else if (value == "grenade") learner_weapon = grenade;
+            else if (value == "hammer") learner_weapon = hammer;
+            else learner_weapon = railgun;
+        } else if (key == "robots") {
+            std::istringstream names(value);
+            std::string name;
+            while (std::getline(names, name, ',')) roster.push_back(name);
+        }
+    }
+    // Every env lets go of its robots at each reset; keep their code loaded in between
+    RobotLibraries::pin(roster);
+
+    size_t slots = envs.size() * learner_count;
+    obs.assign(slots * obs_size, 0);
+    reward.assign(slots, 0.0f);
+    done.assign(envs.size(), 0);
+
+    if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = std::min(threads, batch);
+    if (threads > 1) pool = std::make_unique<WorkerPool>(threads);
+}
+
+bool BatchEnv::reset(uint32_t first_seed) {
+    for (size_t i = 0; i < envs.size(); i++) envs[i].seed = first_seed + static_cast<uint32_t>(i);
+    std::atomic<bool> started = true;
+    for_each_env([this, &started](size_t i) {
+        if (start_episode(i)) observe(i);
+        else started = false;
+    });
+    std::fill(reward.begin(), reward.end(), 0.0f);
+    std::fill(done.begin(), done.end(), 0);
+    return started;
+}
+
+void BatchEnv::step(const int32_t* actions) {
+    for_each_env([this, actions](size_t i) { step_env(i, actions + i * learner_count * action_size); });
+}
+
+// A new match in env `index`; the old one stays if the new one cannot be set up
+bool BatchEnv::start_episode(size_t index) {
+    Env& env = envs[index];
+    auto arena = std::make_unique<Arena>();
+    arena->add_learners(learner_count, learner_move, learner_armor, learner_weapon);
+    std::istringstream settings(config + "\nwatch_live no\nquiet yes\nseed " + std::to_string(env.seed) + "\n");
+    if (!arena->initialize(settings)) return false;
+    env.arena = std::move(arena);
+
+    env.health.resize(env.arena->robot_count());
+    for (size_t r = 0; r < env.health.size(); r++) env.health[r] = env.arena->robot_at(r)->get_health();
+    env.turns.assign(learner_count, {});
+    return true;
+}
+
+void BatchEnv::step_env(size_t index, const int32_t* actions) {
+    Env& env = envs[index];
+    Arena& arena = *env.arena;
+    for (int l = 0; l < learner_count; l++) {
+        const int32_t* action = actions + l * action_size;
+        Arena::LearnerTurn& turn = env.turns[l];
+        turn = {};
+        turn.radar_dir = action[0];
+        if (action[1] == action_shoot) {
+            turn.plan.shoot = true;
+            turn.plan.shot_row = action[2];
+            turn.plan.shot_col = action[3];
+        } else if (action[1] == action_move) {
+            turn.plan.move_direction = action[2];
+            turn.plan.move_distance = action[3];
+        }
+    }
+
+    bool running = arena.step(env.turns.data());
+
+    // Damage dealt to everyone else, less damage taken
+    int lost_total = 0;
+    for (size_t r = 0; r < env.health.size(); r++) {
+        int health = std::max(arena.robot_at(r)->get_health(), 0);
+        lost_total += env.health[r] - health;
+    }
+    float* rewards = reward.data() + index * learner_count;
+    for (int l = 0; l < learner_count; l++) {
+        int lost = env.health[l] - std::max(arena.robot_at(l)->get_health(), 0);
+        int dealt = lost_total - lost;
+        rewards[l] = static_cast<float>(dealt - lost) / 100.0f;
+    }
+    for (size_t r = 0; r < env.health.size(); r++) env.health[r] = std::max(arena.robot_at(r)->get_health(), 0);
+
+    done[index] = !running;
+    if (running) {
+        observe(index);
+        return;
+    }
+
+    // Winning or losing outright is worth a full point; running out of rounds is not
+    const MatchResult& result = arena.match_result();
+    for (int l = 0; l < learner_count; l++) {
+        if (result.outcome == "winner") {
+            rewards[l] += result.winner == arena.robot_at(l)->m_name ? 1.0f : -1.0f;
+        } else if (result.outcome == "no_survivors") {
+            rewards[l] -= 1.0f;
+        }
+    }
+    env.seed += static_cast<uint32_t>(envs.size());
+    if (start_episode(index)) observe(index);
+}
+
+void BatchEnv::observe(size_t index) {
+    Arena& arena = *envs[index].arena;
+    for (int l = 0; l < learner_count; l++) {
+        int32_t* out = obs.data() + (index * learner_count + l) * obs_size;
+        RobotBase* robot = arena.robot_at(l);
+        int row, col;
+        robot->get_current_location(row, col);
+        const std::vector<RadarObj>& radar = arena.last_radar(l);
+        int seen = static_cast<int>(std::min<size_t>(radar.size(), max_radar));
+
+        out[0] = row;
+        out[1] = col;
+        out[2] = std::max(robot->get_health(), 0);
+        out[3] = robot->get_armor();
+        out[4] = robot->get_grenades();
+        out[5] = arena.board_height();
+        out[6] = arena.board_width();
+        out[7] = arena.round();
+        out[8] = seen;
+        int32_t* objects = out + header_size;
+        for (int k = 0; k < seen; k++) {
+            objects[3 * k] = radar[k].m_type;
+            objects[3 * k + 1] = radar[k].m_row;
+            objects[3 * k + 2] = radar[k].m_col;
+        }
+        std::fill(objects + 3 * seen, objects + 3 * max_radar, 0);
+    }
+}
+
+// Runs job on every env: one contiguous chunk of envs per thread
+void BatchEnv::for_each_env(const std::function<void(size_t)>& job) {
+    if (!pool) {
+        for (size_t i = 0; i < envs.size(); i++) job(i);
+        return;
+    }
+    size_t chunks = static_cast<size_t>(pool->size());
+    size_t per_chunk = (envs.size() + chunks - 1) / chunks;
+    std::vector<std::future<void>> finished;
+    for (size_t first = 0; first < envs.size(); first += per_chunk) {
+        size_t last = std::min(envs.size(), first + per_chunk);
+        finished.push_back(pool->submit([&job, first, last] {
+            for (size_t i = first; i < last; i++) job(i);
+        }));
+    }
+    for (auto& chunk : finished) chunk.get();
+}
@@ -0,0 +1,84 @@
+#ifndef BATCH_ENV_H
+#define BATCH_ENV_H
+
+#include "Arena.h"
+#include "WorkerPool.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Many independent arenas stepped together, for training robot AIs. The
+// learner robots in each arena are played from outside: step() takes one
+// action per learner for the whole batch and writes what came of it to flat
+// arrays, env-major then learner, that a training loop can hand straight to
+// its tensors. The rest of each arena is the usual roster of compiled robots
+// (the config's "robots" line), as opponents.
+//
+// The arenas are run in chunks on a thread pool. An env whose match ends is
+// reset at once with its next seed, so every slot always holds a live match;
+// its done flag says the observation is the first of a new episode and the
+// reward the last of the old one.
+//
+// Each robot draws rand() from its own stream (RobotRandom.h), so an env's
+// episode plays the same whatever the thread count.
+class BatchEnv {
+public:
+    // An action: radar direction (0-8), then what to do with the turn -
+    // action_idle, action_shoot at (a, b) = row, col, or action_move in
+    // direction a (1-8) by b cells.
+    static constexpr int action_size = 4;
+    enum ActionKind { action_idle, action_shoot, action_move };
+
+    // An observation: the learner's row, col, health, armor and grenades, the
+    // board rows and cols, the round, and how many radar objects follow; then
+    // max_radar objects as (type, row, col), zero-filled after the count.
+    static constexpr int max_radar = 16;
+    static constexpr int header_size = 9;
+    static constexpr int obs_size = header_size + 3 * max_radar;
+
+    // `config` is arena.config text; its watch_live and seed are replaced.
+    // Learner stats come from learner_move, learner_armor and learner_weapon
+    // (flamethrower, railgun, grenade or hammer) in it. threads 0 = one per core.
+    BatchEnv(int batch, const std::string& config, int learners = 1, int threads = 0);
+
+    // Start every env on a new match: env i's e-th episode is seeded
+    // first_seed + i + e * batch. false if a match cannot be set up (its map).
+    bool reset(uint32_t first_seed);
+    // One round in every env; actions holds batch * learners * action_size.
+    void step(const int32_t* actions);
+
+    int batch() const { return static_cast<int>(envs.size()); }
+    int learners() const { return learner_count; }
+
+    const int32_t* observations() const { return obs.data(); }   // batch * learners * obs_size
+    const float* rewards() const { return reward.data(); }        // batch * learners
+    const uint8_t* dones() const { return done.data(); }          // batch
+
+private:
+    struct Env {
+        std::unique_ptr<Arena> arena;
+        uint32_t seed = 0;
+        std::vector<int> health;          // every robot's, after the last step
+        std::vector<Arena::LearnerTurn> turns;
+    };
+
+    std::string config;
+    int learner_count;
+    int learner_move = 3;
+    int learner_armor = 2;
+    WeaponType learner_weapon = railgun;
+    std::vector<Env> envs;
+    std::vector<int32_t> obs;
+    std::vector<float> reward;
+    std::vector<uint8_t> done;
+    std::unique_ptr<WorkerPool> pool;
+
+    bool start_episode(size_t index);
+    void step_env(size_t index, const int32_t* actions);
+    void observe(size_t index);
+    void for_each_env(const std::function<void(size_t)>& job);
+};
+
+#endif // BATCH_ENV_H
@@ -0,0 +1,220 @@
+#include "DecisionLog.h"
+#include <algorithm>
+#include <bit>
+#include <iostream>
+#include <iterator>
+
+namespace {
+
+const char magic[] = "RWLOG5\n";
+
+enum RecordKind : uint8_t { idle = 0, shoot = 1, move = 2, round_end = 3, disqualify = 4 };
+constexpr int radar_escape = 15;
+
+} // namespace
+
+// ---------------------------------------------------------------- writer
+
+void DecisionLogWriter::put_varint(uint64_t value) {
+    while (value >= 0x80) {
+        put_byte(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    put_byte(static_cast<uint8_t>(value));
+}
+
+// zigzag, so small negative numbers stay small
+void DecisionLogWriter::put_signed(int64_t value) {
+    put_varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void DecisionLogWriter::put_string(const std::string& text) {
+    put_varint(text.size());
+    file.write(text.data(), text.size());
+}
+
+bool DecisionLogWriter::open(const std::string& log_path, const DecisionLogHeader& header) {
+    path = log_path;
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Could not write decision log " << path << "\n";
+        return false;
+    }
+
+    file.write(magic, sizeof(magic) - 1);
+    put_varint(header.seed);
+    put_varint(header.width);
+    put_varint(header.height);
+    put_varint(header.max_rounds);
+    put_varint(header.num_mounds);
+    put_varint(header.num_pits);
+    put_varint(header.num_flamethrowers);
+    put_string(header.map_file);
+    put_varint(header.terrain);
+    put_varint(std::bit_cast<uint64_t>(header.mound_density));
+    put_varint(std::bit_cast<uint64_t>(header.pit_density));
+    put_varint(std::bit_cast<uint64_t>(header.flamethrower_density));
+    put_varint(header.terrain_smoothing);
+    put_varint(header.stalemate_rounds);
+    put_varint(header.stalemate_repeats);
+    put_string(header.stalemate_tiebreak);
+    put_varint(header.simultaneous);
+    put_varint(header.robots.size());
+    for (const auto& robot : header.robots) {
+        put_string(robot.name);
+        put_varint(robot.move);
+        put_varint(robot.armor);
+        put_varint(robot.weapon);
+    }
+    return true;
+}
+
+void DecisionLogWriter::turn(int radar_dir, const TurnPlan& plan) {
+    RecordKind kind = plan.shoot ? shoot : plan.move_distance > 0 ? move : idle;
+    bool plain_dir = radar_dir >= 0 && radar_dir <= 8;
+    put_byte(static_cast<uint8_t>(kind << 4 | (plain_dir ? radar_dir : radar_escape)));
+    if (!plain_dir) put_signed(radar_dir);
+
+    if (kind == shoot) {
+        put_signed(plan.shot_row);
+        put_signed(plan.shot_col);
+    } else if (kind == move) {
+        put_signed(plan.move_direction);
+        put_signed(plan.move_distance);
+    }
+}
+
+void DecisionLogWriter::end_round(uint64_t checksum) {
+    put_byte(round_end << 4);
+    for (int i = 0; i < 8; i++) {
+        put_byte(static_cast<uint8_t>(checksum >> (8 * i)));
+    }
+    file.flush();  // a crashed match still leaves every finished round behind
+}
+
+void DecisionLogWriter::disqualified() {
+    put_byte(disqualify << 4);
+}
+
+// ---------------------------------------------------------------- reader
+
+uint8_t DecisionLogReader::get_byte() {
+    if (pos >= data.size()) {
+        failed = true;
+        return 0;
+    }
+    return data[pos++];
+}
+
+uint64_t DecisionLogReader::get_varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = get_byte();
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) break;
+    }
+    return value;
+}
+
+int64_t DecisionLogReader::get_signed() {
+    uint64_t value = get_varint();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+std::string DecisionLogReader::get_string() {
+    size_t length = get_varint();
+    if (length > data.size() - pos) {
+        failed = true;
+        return "";
+    }
+    std::string text(reinterpret_cast<const char*>(data.data() + pos), length);
+    pos += length;
+    return text;
+}
+
+bool DecisionLogReader::open(const std::string& path, DecisionLogHeader& header) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Could not open decision log " << path << "\n";
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    pos = 0;
+
+    if (data.size() < sizeof(magic) - 1 || !std::equal(magic, magic + sizeof(magic) - 1, data.begin())) {
+        std::cerr << path << " is not a decision log\n";
+        return false;
+    }
+    pos = sizeof(magic) - 1;
+
+    header.seed = static_cast<unsigned>(get_varint());
+    header.width = static_cast<int>(get_varint());
+    header.height = static_cast<int>(get_varint());
+    header.max_rounds = static_cast<int>(get_varint());
+    header.num_mounds = static_cast<int>(get_varint());
+    header.num_pits = static_cast<int>(get_varint());
+    header.num_flamethrowers = static_cast<int>(get_varint());
+    header.map_file = get_string();
+    header.terrain = get_varint() != 0;
+    header.mound_density = std::bit_cast<double>(get_varint());
+    header.pit_density = std::bit_cast<double>(get_varint());
+    header.flamethrower_density = std::bit_cast<double>(get_varint());
+    header.terrain_smoothing = static_cast<int>(get_varint());
+    header.stalemate_rounds = static_cast<int>(get_varint());
+    header.stalemate_repeats = static_cast<int>(get_varint());
+    header.stalemate_tiebreak = get_string();
+    header.simultaneous = get_varint() != 0;
+    size_t count = get_varint();
+    if (count > data.size()) {
+        std::cerr << path << " has a corrupt header\n";
+        return false;
+    }
+    header.robots.resize(count);
+    for (auto& robot : header.robots) {
+        robot.name = get_string();
+        robot.move = static_cast<int>(get_varint());
+        robot.armor = static_cast<int>(get_varint());
+        robot.weapon = static_cast<WeaponType>(get_varint() & 3);
+    }
+    if (failed) {
+        std::cerr << path << " has a truncated header\n";
+        return false;
+    }
+    return true;
+}
+
+bool DecisionLogReader::next_turn(int& radar_dir, TurnPlan& plan) {
+    if (pos >= data.size() || (data[pos] >> 4) == round_end || (data[pos] >> 4) == disqualify) return false;
+
+    uint8_t tag = get_byte();
+    int kind = tag >> 4;
+    radar_dir = tag & 0x0F;
+    if (radar_dir == radar_escape) radar_dir = static_cast<int>(get_signed());
+
+    plan = TurnPlan();
+    if (kind == shoot) {
+        plan.shoot = true;
+        plan.shot_row = static_cast<int>(get_signed());
+        plan.shot_col = static_cast<int>(get_signed());
+    } else if (kind == move) {
+        plan.move_direction = static_cast<int>(get_signed());
+        plan.move_distance = static_cast<int>(get_signed());
+    }
+    return !failed;
+}
+
+bool DecisionLogReader::next_round_end(uint64_t& checksum) {
+    if (pos >= data.size() || (data[pos] >> 4) != round_end) return false;
+    pos++;
+    checksum = 0;
+    for (int i = 0; i < 8; i++) {
+        checksum |= static_cast<uint64_t>(get_byte()) << (8 * i);
+    }
+    return !failed;
+}
+
+bool DecisionLogReader::next_disqualified() {
+    if (pos >= data.size() || (data[pos] >> 4) != disqualify) return false;
+    pos++;
+    return true;
+}
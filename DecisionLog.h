@@ -0,0 +1,105 @@
+#ifndef DECISION_LOG_H
+#define DECISION_LOG_H
+
+#include "RobotBase.h"
+#include "RobotPlanner.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Everything a robot told the arena during a match, in turn order, so the match
+// can be played again without the robot code. Together with the seed and the
+// settings that shape the board, the decisions pin down the whole match: the
+// replay runs the same scan_radar/handle_shot/handle_movement calls and only
+// skips the calls into the robots.
+//
+// File layout: "RWLOG5\n", the header fields as varints (strings as a length
+// and bytes, densities as the bits of the double), then one record per
+// turn and one per round end. A turn is a tag byte (kind << 4 | radar
+// direction, 15 = direction follows as a varint) plus zigzag varints for the
+// shot row/col or the move direction/distance - two to five bytes for most
+// turns. A robot disqualified for its memory use gets a one-byte record. A
+// round end carries a 64-bit checksum of the board and the robots, which the
+// replay compares to detect divergence.
+
+struct DecisionLogHeader {
+    struct Robot {
+        std::string name;
+        int move = 0;
+        int armor = 0;
+        WeaponType weapon = flamethrower;
+    };
+
+    unsigned seed = 0;
+    int width = 0;
+    int height = 0;
+    int max_rounds = 0;
+    int num_mounds = 0;
+    int num_pits = 0;
+    int num_flamethrowers = 0;
+    std::string map_file;                // scenario map the match was played on, if any
+    bool terrain = false;                // board generated by generate_terrain
+    double mound_density = 0;
+    double pit_density = 0;
+    double flamethrower_density = 0;
+    int terrain_smoothing = 0;
+    int stalemate_rounds = 0;            // the match ends early on these (Arena::check_stalemate)
+    int stalemate_repeats = 0;
+    std::string stalemate_tiebreak;
+    bool simultaneous = false;           // turn_mode simultaneous: turns are logged in robot order each round
+    std::vector<Robot> robots;           // roster order
+};
+
+// Stands in for a robot whose decisions come from elsewhere - the log during a
+// replay, the caller of Arena::step for a learner. It has the robot's stats
+// and no decisions of its own; the arena never calls these.
+class ReplayRobot : public RobotBase {
+public:
+    ReplayRobot(int move, int armor, WeaponType weapon) : RobotBase(move, armor, weapon) {}
+
+    void get_radar_direction(int& radar_direction) override { radar_direction = 0; }
+    void process_radar_results(const std::vector<RadarObj>&) override {}
+    bool get_shot_location(int&, int&) override { return false; }
+    void get_move_direction(int& direction, int& distance) override { direction = distance = 0; }
+};
+
+class DecisionLogWriter {
+public:
+    bool open(const std::string& path, const DecisionLogHeader& header);
+    void turn(int radar_dir, const TurnPlan& plan);
+    void end_round(uint64_t checksum);
+    void disqualified();                 // the robot whose turn it is, instead of a turn
+
+private:
+    std::ofstream file;
+    std::string path;
+
+    void put_byte(uint8_t byte) { file.put(static_cast<char>(byte)); }
+    void put_varint(uint64_t value);
+    void put_signed(int64_t value);
+    void put_string(const std::string& text);
+};
+
+class DecisionLogReader {
+public:
+    bool open(const std::string& path, DecisionLogHeader& header);
+
+    // The next record must be a turn / a round end; false when it is not (or
+    // the log has run out), which means the replay has diverged.
+    bool next_turn(int& radar_dir, TurnPlan& plan);
+    bool next_round_end(uint64_t& checksum);
+    bool next_disqualified();            // consumes the record if it is one
+
+private:
+    std::vector<uint8_t> data;
+    size_t pos = 0;
+    bool failed = false;
+
+    uint8_t get_byte();
+    uint64_t get_varint();
+    int64_t get_signed();
+    std::string get_string();
+};
+
+#endif // DECISION_LOG_H
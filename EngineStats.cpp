@@ -0,0 +1,162 @@
+#include "EngineStats.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const char* phase_names[phase_count] = {"radar", "shot", "move", "render", "robot"};
+const char* weapon_names[4] = {"flamethrower", "railgun", "grenade", "hammer"};
+
+double seconds(uint64_t ns) {
+    return ns / 1e9;
+}
+
+double per_second(uint64_t count, double elapsed) {
+    return elapsed > 0 ? count / elapsed : 0.0;
+}
+
+uint64_t total_scans(const EngineStats& stats) {
+    uint64_t total = 0;
+    for (auto n : stats.radar_scans) total += n;
+    return total;
+}
+
+void metric_header(std::ostream& out, const char* name, const char* type, const char* help) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+bool write_atomically(const std::string& path, void (EngineStats::*write)(std::ostream&) const,
+                      const EngineStats& stats) {
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp);
+        if (!file.is_open()) {
+            std::cerr << "Could not write stats file " << tmp << "\n";
+            return false;
+        }
+        (stats.*write)(file);
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::cerr << "Could not replace stats file " << path << ": " << ec.message() << "\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+EngineStats::EngineStats() : started(std::chrono::steady_clock::now()) {}
+
+void EngineStats::start_clock() {
+    started = std::chrono::steady_clock::now();
+}
+
+void EngineStats::add(const EngineStats& other) {
+    rounds += other.rounds;
+    robot_turns += other.robot_turns;
+    moves += other.moves;
+    for (int d = 0; d < 9; d++) radar_scans[d] += other.radar_scans[d];
+    for (int w = 0; w < 4; w++) shots[w] += other.shots[w];
+    for (int p = 0; p < phase_count; p++) phase_ns[p] += other.phase_ns[p];
+}
+
+double EngineStats::elapsed_seconds() const {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+    return elapsed.count();
+}
+
+void EngineStats::write_prometheus(std::ostream& out) const {
+    double elapsed = elapsed_seconds();
+
+    metric_header(out, "robotwarz_rounds_total", "counter", "Rounds played.");
+    out << "robotwarz_rounds_total " << rounds << "\n";
+
+    metric_header(out, "robotwarz_robot_turns_total", "counter", "Robot turns taken.");
+    out << "robotwarz_robot_turns_total " << robot_turns << "\n";
+
+    metric_header(out, "robotwarz_moves_total", "counter", "Move requests handled.");
+    out << "robotwarz_moves_total " << moves << "\n";
+
+    metric_header(out, "robotwarz_radar_scans_total", "counter", "Radar scans by direction.");
+    for (int d = 0; d < 9; d++) {
+        out << "robotwarz_radar_scans_total{direction=\"" << d << "\"} " << radar_scans[d] << "\n";
+    }
+
+    metric_header(out, "robotwarz_shots_total", "counter", "Shots fired by weapon.");
+    for (int w = 0; w < 4; w++) {
+        out << "robotwarz_shots_total{weapon=\"" << weapon_names[w] << "\"} " << shots[w] << "\n";
+    }
+
+    metric_header(out, "robotwarz_phase_seconds_total", "counter", "Time spent in each engine phase.");
+    for (int p = 0; p < phase_count; p++) {
+        out << "robotwarz_phase_seconds_total{phase=\"" << phase_names[p] << "\"} "
+            << seconds(phase_ns[p]) << "\n";
+    }
+
+    metric_header(out, "robotwarz_robot_heap_bytes", "gauge", "Heap bytes each robot holds now.");
+    for (const auto& robot : robot_heap) {
+        out << "robotwarz_robot_heap_bytes{robot=\"" << robot.name << "\"} " << robot.current_bytes << "\n";
+    }
+
+    metric_header(out, "robotwarz_robot_heap_peak_bytes", "gauge", "Most heap bytes each robot has held.");
+    for (const auto& robot : robot_heap) {
+        out << "robotwarz_robot_heap_peak_bytes{robot=\"" << robot.name << "\"} " << robot.peak_bytes << "\n";
+    }
+
+    metric_header(out, "robotwarz_elapsed_seconds", "gauge", "Wall time since the engine started.");
+    out << "robotwarz_elapsed_seconds " << elapsed << "\n";
+
+    metric_header(out, "robotwarz_turns_per_second", "gauge", "Average robot turns per second.");
+    out << "robotwarz_turns_per_second " << per_second(robot_turns, elapsed) << "\n";
+
+    metric_header(out, "robotwarz_radar_scans_per_second", "gauge", "Average radar scans per second.");
+    out << "robotwarz_radar_scans_per_second " << per_second(total_scans(*this), elapsed) << "\n";
+}
+
+void EngineStats::write_json(std::ostream& out) const {
+    double elapsed = elapsed_seconds();
+
+    out << "{\n";
+    out << "  \"elapsed_seconds\": " << elapsed << ",\n";
+    out << "  \"rounds\": " << rounds << ",\n";
+    out << "  \"robot_turns\": " << robot_turns << ",\n";
+    out << "  \"moves\": " << moves << ",\n";
+    out << "  \"turns_per_second\": " << per_second(robot_turns, elapsed) << ",\n";
+    out << "  \"radar_scans_per_second\": " << per_second(total_scans(*this), elapsed) << ",\n";
+
+    out << "  \"radar_scans\": [";
+    for (int d = 0; d < 9; d++) {
+        out << (d ? ", " : "") << radar_scans[d];
+    }
+    out << "],\n";
+
+    out << "  \"shots\": {";
+    for (int w = 0; w < 4; w++) {
+        out << (w ? ", " : "") << "\"" << weapon_names[w] << "\": " << shots[w];
+    }
+    out << "},\n";
+
+    out << "  \"phase_seconds\": {";
+    for (int p = 0; p < phase_count; p++) {
+        out << (p ? ", " : "") << "\"" << phase_names[p] << "\": " << seconds(phase_ns[p]);
+    }
+    out << "},\n";
+
+    out << "  \"robot_heap\": {";
+    for (size_t i = 0; i < robot_heap.size(); i++) {
+        out << (i ? ", " : "") << "\"" << robot_heap[i].name << "\": {\"current_bytes\": " << robot_heap[i].current_bytes
+            << ", \"peak_bytes\": " << robot_heap[i].peak_bytes << "}";
+    }
+    out << "}\n";
+    out << "}\n";
+}
+
+bool EngineStats::write_files(const std::string& base) const {
+    bool prom = write_atomically(base + ".prom", &EngineStats::write_prometheus, *this);
+    bool json = write_atomically(base + ".json", &EngineStats::write_json, *this);
+    return prom && json;
+}
@@ -0,0 +1,73 @@
+#ifndef ENGINE_STATS_H
+#define ENGINE_STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Phases of a robot turn that the engine times.
+enum class Phase { radar, shot, move, render, robot };
+constexpr int phase_count = 5;
+
+// Cheap counters and phase timers the Arena keeps while a match runs.
+// Everything is a plain integer bump; exporting is done every few rounds.
+class EngineStats {
+public:
+    uint64_t rounds = 0;
+    uint64_t robot_turns = 0;
+    uint64_t moves = 0;
+    uint64_t radar_scans[9] = {};   // by radar direction 0-8
+    uint64_t shots[4] = {};         // by WeaponType
+    uint64_t phase_ns[phase_count] = {};
+
+    // Heap held by each robot (see RobotMemory), refreshed before each export
+    struct RobotHeap {
+        std::string name;
+        int64_t current_bytes = 0;
+        int64_t peak_bytes = 0;
+    };
+    std::vector<RobotHeap> robot_heap;
+
+    EngineStats();
+
+    // Restart the wall clock the per-second rates are measured against.
+    void start_clock();
+    // Adds in the counters and timers of another (a lane of a partitioned round).
+    void add(const EngineStats& other);
+    double elapsed_seconds() const;
+
+    void write_prometheus(std::ostream& out) const;
+    void write_json(std::ostream& out) const;
+
+    // Writes <base>.prom and <base>.json. Each file is written to a temp file
+    // and renamed, so a scraper never reads half a file.
+    bool write_files(const std::string& base) const;
+
+private:
+    std::chrono::steady_clock::time_point started;
+};
+
+// Adds the time spent in a scope to one of the phase timers.
+class PhaseTimer {
+public:
+    PhaseTimer(EngineStats& stats, Phase phase)
+        : stats(stats), phase(phase), start(std::chrono::steady_clock::now()) {}
+
+    ~PhaseTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        stats.phase_ns[static_cast<int>(phase)] +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    EngineStats& stats;
+    Phase phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif // ENGINE_STATS_H
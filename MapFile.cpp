@@ -0,0 +1,180 @@
+#include "MapFile.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char magic[8] = {'R', 'W', 'M', 'A', 'P', '1', '\n', '\0'};
+constexpr uint32_t cell_alignment = 4096;  // cells start on a page, so they can be mapped
+
+struct BinaryHeader {
+    char magic[8];
+    uint32_t width;
+    uint32_t height;
+    uint32_t spawn_count;
+    uint32_t cells_offset;
+};
+static_assert(sizeof(BinaryHeader) == 24, "binary map header is 24 bytes");
+
+bool board_cell(char cell) {
+    return cell == '.' || cell == 'M' || cell == 'P' || cell == 'F';
+}
+
+bool check_spawns(const std::string& path, const ArenaGrid& grid, const std::vector<SpawnPoint>& spawns) {
+    for (const auto& spawn : spawns) {
+        if (spawn.row < 0 || spawn.row >= grid.height() || spawn.col < 0 || spawn.col >= grid.width() ||
+            grid.at(spawn.row, spawn.col) != '.') {
+            std::cerr << path << ": spawn point (" << spawn.row << ", " << spawn.col << ") is not an empty cell\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool load_binary_map(const std::string& path, int fd, ArenaGrid& grid, std::vector<SpawnPoint>& spawns) {
+    BinaryHeader header;
+    struct stat info;
+    if (pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) || fstat(fd, &info) != 0) {
+        std::cerr << path << ": truncated map header\n";
+        return false;
+    }
+
+    uint64_t cell_count = uint64_t(header.width) * header.height;
+    uint64_t spawn_bytes = uint64_t(header.spawn_count) * 2 * sizeof(uint32_t);
+    if (header.width == 0 || header.height == 0 || header.width > INT32_MAX || header.height > INT32_MAX ||
+        header.cells_offset % cell_alignment != 0 || sizeof(header) + spawn_bytes > header.cells_offset ||
+        header.cells_offset + cell_count > static_cast<uint64_t>(info.st_size)) {
+        std::cerr << path << ": corrupt map header\n";
+        return false;
+    }
+
+    std::vector<uint32_t> points(header.spawn_count * 2);
+    if (pread(fd, points.data(), spawn_bytes, sizeof(header)) != static_cast<ssize_t>(spawn_bytes)) {
+        std::cerr << path << ": truncated spawn points\n";
+        return false;
+    }
+
+    // Private mapping: the arena writes to its board, never to the file
+    void* cells = mmap(nullptr, cell_count, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, header.cells_offset);
+    if (cells == MAP_FAILED) {
+        std::cerr << path << ": cannot map cells: " << strerror(errno) << "\n";
+        return false;
+    }
+    std::shared_ptr<void> mapping(cells, [cell_count](void* p) { munmap(p, cell_count); });
+    const char* cell = static_cast<const char*>(cells);
+    for (uint64_t i = 0; i < cell_count; i++) {
+        if (!board_cell(cell[i])) {
+            std::cerr << path << ": unknown cell '" << cell[i] << "' at (" << i / header.width << ", "
+                      << i % header.width << ")\n";
+            return false;
+        }
+    }
+    grid.adopt(static_cast<char*>(cells), static_cast<int>(header.height), static_cast<int>(header.width), mapping);
+
+    spawns.clear();
+    for (uint32_t i = 0; i < header.spawn_count; i++) {
+        spawns.push_back({static_cast<int>(points[2 * i]), static_cast<int>(points[2 * i + 1])});
+    }
+    return check_spawns(path, grid, spawns);
+}
+
+bool load_text_map(const std::string& path, ArenaGrid& grid, std::vector<SpawnPoint>& spawns) {
+    std::ifstream file(path);
+    std::vector<std::string> rows;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        if (!rows.empty() && line.size() != rows[0].size()) {
+            std::cerr << path << ": row " << rows.size() + 1 << " is " << line.size() << " cells wide, expected "
+                      << rows[0].size() << "\n";
+            return false;
+        }
+        rows.push_back(line);
+    }
+    if (rows.empty()) {
+        std::cerr << path << ": no board rows\n";
+        return false;
+    }
+
+    grid.reset(static_cast<int>(rows.size()), static_cast<int>(rows[0].size()));
+    spawns.clear();
+    for (int r = 0; r < grid.height(); r++) {
+        for (int c = 0; c < grid.width(); c++) {
+            char cell = rows[r][c];
+            if (cell == 'S') {
+                spawns.push_back({r, c});
+            } else if (board_cell(cell)) {
+                grid.set(r, c, cell);
+            } else {
+                std::cerr << path << ": unknown cell '" << cell << "' at (" << r << ", " << c << ")\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool load_map(const std::string& path, ArenaGrid& grid, std::vector<SpawnPoint>& spawns) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Could not open map " << path << ": " << strerror(errno) << "\n";
+        return false;
+    }
+    char start[sizeof(magic)] = {};
+    bool binary = pread(fd, start, sizeof(start), 0) == static_cast<ssize_t>(sizeof(start)) &&
+                  std::memcmp(start, magic, sizeof(magic)) == 0;
+    bool loaded = binary ? load_binary_map(path, fd, grid, spawns) : load_text_map(path, grid, spawns);
+    close(fd);
+    return loaded;
+}
+
+bool save_binary_map(const std::string& path, const ArenaGrid& grid, const std::vector<SpawnPoint>& spawns) {
+    BinaryHeader header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.width = grid.width();
+    header.height = grid.height();
+    header.spawn_count = static_cast<uint32_t>(spawns.size());
+    uint64_t used = sizeof(header) + uint64_t(spawns.size()) * 2 * sizeof(uint32_t);
+    header.cells_offset = static_cast<uint32_t>((used + cell_alignment - 1) / cell_alignment * cell_alignment);
+
+    std::string tmp = path + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Could not write map " << tmp << "\n";
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const auto& spawn : spawns) {
+            uint32_t point[2] = {static_cast<uint32_t>(spawn.row), static_cast<uint32_t>(spawn.col)};
+            file.write(reinterpret_cast<const char*>(point), sizeof(point));
+        }
+        std::vector<char> padding(header.cells_offset - used, 0);
+        file.write(padding.data(), padding.size());
+        for (int r = 0; r < grid.height(); r++) {
+            file.write(grid.row(r), grid.width());
+        }
+        if (!file) {
+            std::cerr << "Could not write map " << tmp << "\n";
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::cerr << "Could not store map " << path << ": " << ec.message() << "\n";
+        return false;
+    }
+    return true;
+}
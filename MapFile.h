@@ -0,0 +1,33 @@
+#ifndef MAP_FILE_H
+#define MAP_FILE_H
+
+#include "ArenaGrid.h"
+#include <string>
+#include <vector>
+
+// Scenario maps: an exact board layout instead of randomly placed obstacles.
+//
+// Text maps are for drawing by hand. One line per board row, all the same
+// length, using the board characters '.', 'M', 'P' and 'F', plus 'S' for a
+// robot spawn point (an empty cell robots are placed on first, in roster
+// order). Lines starting with '#' are comments.
+//
+// Binary maps are for large generated boards. The file is an 8-byte magic
+// "RWMAP1\n\0", then width, height, spawn count and the offset of the cells
+// as native-endian uint32, the spawn points as (row, col) uint32 pairs, and at
+// that page-aligned offset the cells themselves, row-major, one board
+// character each. load_map maps the cells privately (copy-on-write), checks
+// them in one pass and hands them to the grid as its storage - no copy.
+
+struct SpawnPoint {
+    int row;
+    int col;
+};
+
+// Loads either format, chosen by the file's first bytes. Prints why and
+// returns false if the file cannot be used.
+bool load_map(const std::string& path, ArenaGrid& grid, std::vector<SpawnPoint>& spawns);
+
+bool save_binary_map(const std::string& path, const ArenaGrid& grid, const std::vector<SpawnPoint>& spawns);
+
+#endif // MAP_FILE_H
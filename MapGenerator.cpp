@@ -0,0 +1,242 @@
+#include "MapGenerator.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int band_rows = 64;           // rows per parallel job
+constexpr int calibration_samples = 16384;
+constexpr float corridor_width = 0.04f; // of the corridor field's range around 0.5
+
+uint64_t mix(uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h;
+}
+
+uint32_t hash(uint32_t seed, int x, int y) {
+    uint64_t point = uint64_t(static_cast<uint32_t>(x)) << 32 | static_cast<uint32_t>(y);
+    return static_cast<uint32_t>(mix(point ^ mix(seed + 0x9e3779b97f4a7c15ull)));
+}
+
+float unit(uint32_t h) { return static_cast<float>(h >> 8) * (1.0f / 16777216.0f); }
+
+// Value noise: random values on a lattice `spacing` cells apart, smoothly
+// interpolated in between. Two octaves per field.
+struct Octave {
+    uint32_t seed;
+    int spacing;
+    float weight;
+    std::vector<float> fade;            // smoothstep weight for each offset within a lattice cell
+
+    Octave(uint32_t s, int cells, float w) : seed(s), spacing(cells), weight(w), fade(cells) {
+        for (int i = 0; i < cells; i++) {
+            float t = static_cast<float>(i) / cells;
+            fade[i] = t * t * (3 - 2 * t);
+        }
+    }
+};
+
+struct Field {
+    Octave octaves[2];
+
+    Field(uint32_t seed, int spacing)
+        : octaves{Octave(seed, spacing, 2.0f / 3), Octave(seed ^ 0x5bd1e995u, spacing / 2, 1.0f / 3)} {}
+
+    // Adds the field along board row `row` to out[0..cols)
+    void row(int row, int cols, float* out, std::vector<float>& column) const {
+        for (const auto& octave : octaves) {
+            int ly = row / octave.spacing;
+            float fy = octave.fade[row % octave.spacing];
+            int lattice_cols = cols / octave.spacing + 2;
+            column.resize(lattice_cols);
+            for (int lx = 0; lx < lattice_cols; lx++) {
+                float top = unit(hash(octave.seed, lx, ly));
+                float bottom = unit(hash(octave.seed, lx, ly + 1));
+                column[lx] = top + (bottom - top) * fy;
+            }
+            for (int lx = 0; lx * octave.spacing < cols; lx++) {
+                float left = column[lx] * octave.weight;
+                float right = column[lx + 1] * octave.weight;
+                int first = lx * octave.spacing;
+                int last = std::min(cols, first + octave.spacing);
+                for (int c = first; c < last; c++) {
+                    out[c] += left + (right - left) * octave.fade[c - first];
+                }
+            }
+        }
+    }
+
+    float at(int row, int col) const {
+        float value = 0;
+        for (const auto& octave : octaves) {
+            int ly = row / octave.spacing, lx = col / octave.spacing;
+            float fy = octave.fade[row % octave.spacing];
+            float top = unit(hash(octave.seed, lx, ly));
+            float left = top + (unit(hash(octave.seed, lx, ly + 1)) - top) * fy;
+            top = unit(hash(octave.seed, lx + 1, ly));
+            float right = top + (unit(hash(octave.seed, lx + 1, ly + 1)) - top) * fy;
+            left *= octave.weight;
+            right *= octave.weight;
+            value += left + (right - left) * octave.fade[col % octave.spacing];
+        }
+        return value;
+    }
+};
+
+float ridge(float noise) { return 1 - std::fabs(2 * noise - 1); }
+bool in_corridor(float noise) { return std::fabs(noise - 0.5f) < corridor_width / 2; }
+
+// Noise values are not uniform, so the cut-off giving a density is measured:
+// the (1 - density) quantile of the field over sampled cells.
+float threshold(std::vector<float>& samples, double density) {
+    if (density <= 0) return 2;         // above every value
+    if (density >= 1) return -1;
+    std::sort(samples.begin(), samples.end());
+    return samples[static_cast<size_t>((1 - density) * samples.size())];
+}
+
+struct Terrain {
+    Field mounds, pits, corridors;
+    float mound_cut, pit_cut;
+    uint32_t flame_seed;
+    uint32_t flame_cut;                 // hash below this on a corridor cell = flamethrower
+
+    Terrain(const TerrainSettings& settings, int rows, int cols)
+        : mounds(settings.seed ^ 0x6d6f756eu, 48),
+          pits(settings.seed ^ 0x70697473u, 24),
+          corridors(settings.seed ^ 0x666c616du, 64),
+          flame_seed(settings.seed ^ 0x66697265u) {
+        std::vector<float> mound_samples, pit_samples;
+        int corridor_hits = 0;
+        for (int i = 0; i < calibration_samples; i++) {
+            uint32_t h = hash(settings.seed, i, -1);
+            int r = static_cast<int>(h % static_cast<uint32_t>(rows));
+            int c = static_cast<int>(hash(settings.seed, i, -2) % static_cast<uint32_t>(cols));
+            mound_samples.push_back(ridge(mounds.at(r, c)));
+            pit_samples.push_back(pits.at(r, c));
+            corridor_hits += in_corridor(corridors.at(r, c));
+        }
+        mound_cut = threshold(mound_samples, settings.mound_density);
+        pit_cut = threshold(pit_samples, settings.pit_density);
+        double on_corridor = std::max(corridor_hits, 1) / double(calibration_samples);
+        double chance = std::clamp(settings.flamethrower_density / on_corridor, 0.0, 1.0);
+        flame_cut = static_cast<uint32_t>(std::min(chance * 4294967296.0, 4294967295.0));
+    }
+
+    void fill(ArenaGrid& grid, int first, int last) const {
+        int cols = grid.width();
+        std::vector<float> mound(cols), pit(cols), corridor(cols), column;
+        for (int r = first; r < last; r++) {
+            std::fill(mound.begin(), mound.end(), 0.0f);
+            std::fill(pit.begin(), pit.end(), 0.0f);
+            std::fill(corridor.begin(), corridor.end(), 0.0f);
+            mounds.row(r, cols, mound.data(), column);
+            pits.row(r, cols, pit.data(), column);
+            corridors.row(r, cols, corridor.data(), column);
+
+            char* cells = grid.row(r);
+            for (int c = 0; c < cols; c++) {
+                char cell = pit[c] > pit_cut ? 'P' : '.';
+                cells[c] = ridge(mound[c]) > mound_cut ? 'M' : cell;
+            }
+            for (int c = 0; c < cols; c++) {
+                if (cells[c] == '.' && in_corridor(corridor[c]) && hash(flame_seed, c, r) < flame_cut) cells[c] = 'F';
+            }
+        }
+    }
+};
+
+// The cellular-automaton rule as a table, indexed by the cell and the number
+// of mounds and pits in its 3x3 neighbourhood (itself included): mounds and
+// pits survive with two like neighbours, empty cells turn with five. A lookup
+// instead of branches, since on noise boundaries the branches are coin flips.
+struct SmoothingRule {
+    char next[256][10][10];
+
+    SmoothingRule() {
+        for (int cell = 0; cell < 256; cell++) {
+            for (int m = 0; m < 10; m++) {
+                for (int p = 0; p < 10; p++) {
+                    char result = static_cast<char>(cell);
+                    if (cell == 'M') result = m >= 3 ? 'M' : '.';
+                    else if (cell == 'P') result = p >= 3 ? 'P' : '.';
+                    else if (cell == '.') result = m >= 5 ? 'M' : p >= 5 ? 'P' : '.';
+                    next[cell][m][p] = result;
+                }
+            }
+        }
+    }
+};
+
+// One pass over rows [first, last). Rows are rewritten in place, so the rows
+// just outside the band come from `above`/`below`, copied before any band
+// started.
+void smooth(ArenaGrid& grid, int first, int last, const std::vector<char>& above, const std::vector<char>& below,
+            const SmoothingRule& rule) {
+    int cols = grid.width();
+    std::vector<char> prev(above), cur(grid.row(first), grid.row(first) + cols), next(cols);
+    // Column sums over three rows, padded by one empty column on each side
+    std::vector<uint8_t> mound_sum(cols + 2, 0), pit_sum(cols + 2, 0);
+
+    for (int r = first; r < last; r++) {
+        if (r + 1 < last) std::memcpy(next.data(), grid.row(r + 1), cols);
+        else next = below;
+
+        for (int c = 0; c < cols; c++) {
+            mound_sum[c + 1] = (prev[c] == 'M') + (cur[c] == 'M') + (next[c] == 'M');
+            pit_sum[c + 1] = (prev[c] == 'P') + (cur[c] == 'P') + (next[c] == 'P');
+        }
+        char* out = grid.row(r);
+        for (int c = 0; c < cols; c++) {
+            int m = mound_sum[c] + mound_sum[c + 1] + mound_sum[c + 2];
+            int p = pit_sum[c] + pit_sum[c + 1] + pit_sum[c + 2];
+            out[c] = rule.next[static_cast<uint8_t>(cur[c])][m][p];
+        }
+        std::swap(prev, cur);
+        std::swap(cur, next);
+    }
+}
+
+} // namespace
+
+void generate_terrain(ArenaGrid& grid, int rows, int cols, const TerrainSettings& settings) {
+    grid.reset(rows, cols);
+    if (rows <= 0 || cols <= 0) return;
+
+    Terrain terrain(settings, rows, cols);
+    int bands = (rows + band_rows - 1) / band_rows;
+    int threads = settings.threads > 0 ? settings.threads : static_cast<int>(std::thread::hardware_concurrency());
+    WorkerPool pool(std::clamp(threads, 1, bands));
+
+    auto each_band = [&](auto job) {
+        std::vector<std::future<void>> done;
+        for (int b = 0; b < bands; b++) {
+            int first = b * band_rows, last = std::min(rows, first + band_rows);
+            done.push_back(pool.submit([&job, b, first, last] { job(b, first, last); }));
+        }
+        for (auto& band : done) band.get();
+    };
+
+    each_band([&](int, int first, int last) { terrain.fill(grid, first, last); });
+
+    SmoothingRule rule;
+    std::vector<char> empty(cols, '.');
+    std::vector<std::vector<char>> above(bands), below(bands);
+    for (int pass = 0; pass < settings.smoothing; pass++) {
+        for (int b = 0; b < bands; b++) {
+            int first = b * band_rows, last = std::min(rows, first + band_rows);
+            above[b] = first > 0 ? std::vector<char>(grid.row(first - 1), grid.row(first - 1) + cols) : empty;
+            below[b] = last < rows ? std::vector<char>(grid.row(last), grid.row(last) + cols) : empty;
+        }
+        each_band([&](int b, int first, int last) { smooth(grid, first, last, above[b], below[b], rule); });
+    }
+}
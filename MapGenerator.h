@@ -0,0 +1,30 @@
+#ifndef MAP_GENERATOR_H
+#define MAP_GENERATOR_H
+
+#include "ArenaGrid.h"
+#include <cstdint>
+
+// Procedural terrain for boards too large to furnish obstacle by obstacle.
+//
+// Every cell is a pure function of the seed and its coordinates - hashed
+// lattice noise, no shared random state - so the board is cut into bands of
+// rows that are filled in parallel, and the result is the same whatever the
+// number of threads:
+//  - mounds follow the ridge lines of one noise field,
+//  - pits gather in clusters where a second field peaks,
+//  - flamethrowers are scattered along the winding contour corridors of a third.
+// A few cellular-automaton passes then smooth mounds and pits: specks vanish,
+// ragged edges fill in, one-cell ridges survive.
+struct TerrainSettings {
+    uint32_t seed = 0;
+    double mound_density = 0.08;         // fraction of the board, before smoothing
+    double pit_density = 0.03;
+    double flamethrower_density = 0.002;
+    int smoothing = 2;                   // cellular-automaton passes
+    int threads = 0;                     // 0 = one per core
+};
+
+// Resizes `grid` to rows x cols and fills every cell.
+void generate_terrain(ArenaGrid& grid, int rows, int cols, const TerrainSettings& settings);
+
+#endif // MAP_GENERATOR_H
@@ -0,0 +1,102 @@
+#include "MatchCache.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <unistd.h>
+
+namespace {
+
+// FNV-1a, 64 bit
+constexpr uint64_t fnv_offset = 1469598103934665603ull;
+constexpr uint64_t fnv_prime = 1099511628211ull;
+
+uint64_t fnv1a(const char* data, size_t size, uint64_t hash = fnv_offset) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= fnv_prime;
+    }
+    return hash;
+}
+
+std::string hex(uint64_t value) {
+    std::ostringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << value;
+    return out.str();
+}
+
+} // namespace
+
+MatchCache::MatchCache(const std::string& directory) : directory(directory) {
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        std::cerr << "Could not create match cache " << directory << ": " << ec.message() << "\n";
+    }
+}
+
+uint64_t MatchCache::hash_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return 0;
+
+    uint64_t hash = fnv_offset;
+    char buffer[64 * 1024];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+        hash = fnv1a(buffer, file.gcount(), hash);
+    }
+    return hash;
+}
+
+std::string MatchCache::make_key(const std::vector<std::pair<std::string, std::string>>& robot_libraries,
+                                 const std::string& robot_base_object,
+                                 const std::string& normalized_config,
+                                 unsigned seed) {
+    std::ostringstream material;
+    for (const auto& [name, so_file] : robot_libraries) {
+        material << "robot " << name << " " << hex(hash_file(so_file)) << "\n";
+    }
+    material << "robotbase " << hex(hash_file(robot_base_object)) << "\n";
+    material << normalized_config;
+    material << "seed " << seed << "\n";
+
+    std::string text = material.str();
+    return hex(fnv1a(text.data(), text.size()));
+}
+
+std::string MatchCache::path_for(const std::string& key) const {
+    return directory + "/" + key + ".match";
+}
+
+bool MatchCache::lookup(const std::string& key, MatchResult& result) const {
+    std::ifstream file(path_for(key));
+    if (!file.is_open()) return false;
+
+    MatchResult cached;
+    std::string line;
+    while (std::getline(file, line)) {
+        cached.read_line(line);
+    }
+    if (cached.outcome == "unfinished") return false;  // torn or foreign file
+
+    result = cached;
+    return true;
+}
+
+void MatchCache::store(const std::string& key, const MatchResult& result) const {
+    std::string path = path_for(key);
+    std::string tmp = path + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream file(tmp);
+        if (!file.is_open()) {
+            std::cerr << "Could not write match cache entry " << tmp << "\n";
+            return;
+        }
+        result.write_lines(file);
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::cerr << "Could not store match cache entry " << path << ": " << ec.message() << "\n";
+    }
+}
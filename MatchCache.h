@@ -0,0 +1,34 @@
+#ifndef MATCH_CACHE_H
+#define MATCH_CACHE_H
+
+#include "MatchResult.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Persistent on-disk cache of match outcomes. A match is identified by the
+// content of every robot library, RobotBase.o, the normalized config and the
+// seed - if none of those changed, the match plays out the same way.
+class MatchCache {
+public:
+    explicit MatchCache(const std::string& directory);
+
+    // Content hash of a file, or 0 if it cannot be read.
+    static uint64_t hash_file(const std::string& path);
+
+    // Key for a match. robot_libraries are (robot name, .so path) pairs in roster order.
+    static std::string make_key(const std::vector<std::pair<std::string, std::string>>& robot_libraries,
+                                const std::string& robot_base_object,
+                                const std::string& normalized_config,
+                                unsigned seed);
+
+    bool lookup(const std::string& key, MatchResult& result) const;
+    void store(const std::string& key, const MatchResult& result) const;
+
+private:
+    std::string directory;
+
+    std::string path_for(const std::string& key) const;
+};
+
+#endif // MATCH_CACHE_H
@@ -0,0 +1,22 @@
+#include "MatchObserver.h"
+#include <dlfcn.h>
+#include <iostream>
+
+MatchObserver* load_observer_plugin(const std::string& so_file) {
+    // A bare name would be looked up on the library path, not here
+    std::string path = so_file.find('/') == std::string::npos ? "./" + so_file : so_file;
+    void* handle = dlopen(path.c_str(), RTLD_NOW);
+    if (!handle) {
+        std::cerr << "Failed to load observer " << so_file << ": " << dlerror() << "\n";
+        return nullptr;
+    }
+
+    typedef MatchObserver* (*ObserverFactory)();
+    auto create_match_observer = (ObserverFactory)dlsym(handle, "create_match_observer");
+    if (!create_match_observer) {
+        std::cerr << "Failed to find create_match_observer in " << so_file << "\n";
+        dlclose(handle);
+        return nullptr;
+    }
+    return create_match_observer();
+}
@@ -0,0 +1,153 @@
+#ifndef MATCH_OBSERVER_H
+#define MATCH_OBSERVER_H
+
+#include "RobotBase.h"
+#include "RadarObj.h"
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Engine events, for anything that follows a match - logging, stats, replays,
+// UIs - without touching the arena's code.
+//
+// The arena takes its observer as a template parameter (BasicArena<Observer>,
+// Arena.h). The default, NullObserver, turns every event site into nothing at
+// compile time: the headless arena pays for no event it doesn't report. An
+// observer known at compile time derives from NullObserver and hides the hooks
+// it wants; an arena instantiated with it (see the end of Arena.cpp) calls them
+// directly, no virtual dispatch. DynamicObserver is the runtime variant: a
+// list of MatchObserver objects, possibly loaded from plugins.
+//
+// Rounds are numbered from 1, as the commentary does. Robot pointers are only
+// valid during the call.
+struct TurnStartEvent {
+    int round;
+    RobotBase* robot;
+};
+
+struct RadarScanEvent {
+    int round;
+    RobotBase* robot;
+    int direction;
+    const std::vector<RadarObj>& results;
+};
+
+// Before the shot is resolved; at (row, col) is where the robot aimed
+struct ShotEvent {
+    int round;
+    RobotBase* shooter;
+    WeaponType weapon;
+    int row;
+    int col;
+};
+
+struct HitEvent {
+    int round;
+    RobotBase* shooter;
+    RobotBase* target;
+    WeaponType weapon;
+    int row;
+    int col;
+    int damage;
+};
+
+// Only moves that got somewhere
+struct MoveEvent {
+    int round;
+    RobotBase* robot;
+    int from_row;
+    int from_col;
+    int to_row;
+    int to_col;
+};
+
+struct PitEvent {
+    int round;
+    RobotBase* robot;
+    int row;
+    int col;
+};
+
+struct FlameDamageEvent {
+    int round;
+    RobotBase* robot;
+    int row;
+    int col;
+    int damage;
+};
+
+// killer is null for flames and disqualification
+struct DeathEvent {
+    int round;
+    RobotBase* robot;
+    RobotBase* killer;
+};
+
+struct RoundEndEvent {
+    int round;
+    int robots_alive;
+};
+
+class NullObserver {
+public:
+    void turn_start(const TurnStartEvent&) {}
+    void radar_scan(const RadarScanEvent&) {}
+    void shot(const ShotEvent&) {}
+    void hit(const HitEvent&) {}
+    void move(const MoveEvent&) {}
+    void pit(const PitEvent&) {}
+    void flame_damage(const FlameDamageEvent&) {}
+    void death(const DeathEvent&) {}
+    void round_end(const RoundEndEvent&) {}
+};
+
+// Does the arena build events for this observer at all?
+template <typename Observer>
+constexpr bool observes_events = !std::is_same_v<Observer, NullObserver>;
+
+// Runtime-dispatched observer; override the events of interest.
+class MatchObserver {
+public:
+    virtual ~MatchObserver() = default;
+
+    virtual void turn_start(const TurnStartEvent&) {}
+    virtual void radar_scan(const RadarScanEvent&) {}
+    virtual void shot(const ShotEvent&) {}
+    virtual void hit(const HitEvent&) {}
+    virtual void move(const MoveEvent&) {}
+    virtual void pit(const PitEvent&) {}
+    virtual void flame_damage(const FlameDamageEvent&) {}
+    virtual void death(const DeathEvent&) {}
+    virtual void round_end(const RoundEndEvent&) {}
+};
+
+// Passes every event on to each attached MatchObserver, in the order attached.
+// It does not own them.
+class DynamicObserver {
+public:
+    void add(MatchObserver* observer) { observers.push_back(observer); }
+    bool empty() const { return observers.empty(); }
+
+    void turn_start(const TurnStartEvent& event) { for (auto o : observers) o->turn_start(event); }
+    void radar_scan(const RadarScanEvent& event) { for (auto o : observers) o->radar_scan(event); }
+    void shot(const ShotEvent& event) { for (auto o : observers) o->shot(event); }
+    void hit(const HitEvent& event) { for (auto o : observers) o->hit(event); }
+    void move(const MoveEvent& event) { for (auto o : observers) o->move(event); }
+    void pit(const PitEvent& event) { for (auto o : observers) o->pit(event); }
+    void flame_damage(const FlameDamageEvent& event) { for (auto o : observers) o->flame_damage(event); }
+    void death(const DeathEvent& event) { for (auto o : observers) o->death(event); }
+    void round_end(const RoundEndEvent& event) { for (auto o : observers) o->round_end(event); }
+
+private:
+    std::vector<MatchObserver*> observers;
+};
+
+// A plugin is a shared library exporting
+//
+//   extern "C" MatchObserver* create_match_observer()
+//
+// Loads it (the library stays loaded for the life of the process) and returns
+// a new observer, or null with the reason on stderr.
+MatchObserver* load_observer_plugin(const std::string& so_file);
+
+#endif // MATCH_OBSERVER_H
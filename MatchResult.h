@@ -0,0 +1,77 @@
+#ifndef MATCH_RESULT_H
+#define MATCH_RESULT_H
+
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// How a match ended, and where every robot finished.
+struct MatchResult {
+    // What a robot did over the match
+    struct RobotStats {
+        int shots[4] = {};               // by WeaponType: flamethrower, railgun, grenade, hammer
+        int hits = 0;                    // robots struck, once per robot per shot
+        int damage_dealt = 0;
+        int damage_taken = 0;            // shots and flames
+        int pit_falls = 0;
+        int flame_burns = 0;             // flamethrower cells moved through
+        int rounds_survived = 0;
+        int distance_moved = 0;          // cells
+    };
+
+    struct RobotResult {
+        std::string name;
+        int health = 0;
+        int armor = 0;
+        RobotStats stats;
+    };
+
+    std::string outcome = "unfinished";  // "winner", "no_survivors", "max_rounds", "stalemate",
+                                         // or "crashed" for a tournament match no worker finished
+                                         // (or that could not be set up)
+    std::string winner;                  // robot name when outcome is "winner", or a stalemate's
+                                         // tiebreak picked one
+    int rounds = 0;
+    std::vector<RobotResult> robots;
+
+    // Line format shared by the match cache and the tournament wire protocol:
+    // "outcome ...", "winner ...", "rounds ..." and one "robot name health armor"
+    // per robot, each followed by a "stats ..." line with its RobotStats.
+    void write_lines(std::ostream& out) const {
+        out << "outcome " << outcome << "\n";
+        if (!winner.empty()) out << "winner " << winner << "\n";
+        out << "rounds " << rounds << "\n";
+        for (const auto& robot : robots) {
+            out << "robot " << robot.name << " " << robot.health << " " << robot.armor << "\n";
+            const RobotStats& stats = robot.stats;
+            out << "stats";
+            for (int shots : stats.shots) out << " " << shots;
+            out << " " << stats.hits << " " << stats.damage_dealt << " " << stats.damage_taken << " "
+                << stats.pit_falls << " " << stats.flame_burns << " " << stats.rounds_survived << " "
+                << stats.distance_moved << "\n";
+        }
+    }
+
+    // Takes one line written by write_lines; unknown tags are ignored.
+    void read_line(const std::string& line) {
+        std::istringstream fields(line);
+        std::string tag;
+        fields >> tag;
+        if (tag == "outcome") fields >> outcome;
+        else if (tag == "winner") fields >> winner;
+        else if (tag == "rounds") fields >> rounds;
+        else if (tag == "robot") {
+            RobotResult robot;
+            fields >> robot.name >> robot.health >> robot.armor;
+            robots.push_back(robot);
+        } else if (tag == "stats" && !robots.empty()) {
+            RobotStats& stats = robots.back().stats;
+            for (int& shots : stats.shots) fields >> shots;
+            fields >> stats.hits >> stats.damage_dealt >> stats.damage_taken >> stats.pit_falls >> stats.flame_burns
+                   >> stats.rounds_survived >> stats.distance_moved;
+        }
+    }
+};
+
+#endif // MATCH_RESULT_H
@@ -0,0 +1,328 @@
+#include "RadarEngine.h"
+#include "WeaponPatterns.h"
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// One object a lane of the beam ran into, `dist` steps from the robot.
+struct Hit {
+    int dist;
+    int row;
+    int col;
+};
+
+// The three lanes of a beam, each nearest first.
+struct Lanes {
+    std::pmr::vector<Hit> lane[3];
+
+    explicit Lanes(std::pmr::memory_resource* scratch)
+        : lane{std::pmr::vector<Hit>(scratch), std::pmr::vector<Hit>(scratch), std::pmr::vector<Hit>(scratch)} {}
+
+    // Merge into scan order: by distance, then lane -1, 0, +1.
+    void emit(const ArenaGrid& grid, std::vector<RadarObj>& results) const {
+        size_t i[3] = {0, 0, 0};
+        for (;;) {
+            int best = -1;
+            for (int l = 0; l < 3; l++) {
+                if (i[l] < lane[l].size() && (best < 0 || lane[l][i[l]].dist < lane[best][i[best]].dist)) {
+                    best = l;
+                }
+            }
+            if (best < 0) return;
+            const Hit& hit = lane[best][i[best]++];
+            results.emplace_back(grid.at(hit.row, hit.col), hit.row, hit.col);
+        }
+    }
+};
+
+bool in_bounds(const ArenaGrid& grid, int row, int col) {
+    return row >= 0 && row < grid.height() && col >= 0 && col < grid.width();
+}
+
+// direction 0: the 8 surrounding cells, row by row
+void scan_neighbours(const ArenaGrid& grid, int row, int col, std::vector<RadarObj>& results) {
+    for (int dr = -1; dr <= 1; dr++) {
+        for (int dc = -1; dc <= 1; dc++) {
+            if (dr == 0 && dc == 0) continue;
+            int r = row + dr;
+            int c = col + dc;
+            if (in_bounds(grid, r, c) && grid.at(r, c) != '.') {
+                results.emplace_back(grid.at(r, c), r, c);
+            }
+        }
+    }
+}
+
+// Cell by cell along a beam. Once the centre lane leaves the board the side
+// lanes have too.
+void walk_beam(const ArenaGrid& grid, int row, int col, int direction, std::vector<RadarObj>& results) {
+    int reach = std::max(grid.height(), grid.width());
+    for (int dist = 1; dist < reach; dist++) {
+        CellOffset centre = beam_offset(direction, dist, 0);
+        if (!in_bounds(grid, row + centre.dr, col + centre.dc)) break;
+        for (int lane = -1; lane <= 1; lane++) {
+            CellOffset offset = beam_offset(direction, dist, lane);
+            int r = row + offset.dr;
+            int c = col + offset.dc;
+            if (in_bounds(grid, r, c) && grid.at(r, c) != '.') {
+                results.emplace_back(grid.at(r, c), r, c);
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------- dense
+
+// Calls visit(i) for each i in [begin, end) with data[i] != '.', ascending.
+template <typename Visit>
+void for_each_object_up(const char* data, int begin, int end, Visit visit) {
+    int i = begin;
+#if defined(__SSE2__)
+    const __m128i empty = _mm_set1_epi8('.');
+    for (; i + 16 <= end; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        unsigned mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(block, empty)) & 0xFFFFu;
+        while (mask) {
+            visit(i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < end; i++) {
+        if (data[i] != '.') visit(i);
+    }
+}
+
+// Same, descending from end - 1 down to begin.
+template <typename Visit>
+void for_each_object_down(const char* data, int begin, int end, Visit visit) {
+    int i = end;
+#if defined(__SSE2__)
+    const __m128i empty = _mm_set1_epi8('.');
+    while (i - 16 >= begin) {
+        i -= 16;
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        unsigned mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(block, empty)) & 0xFFFFu;
+        while (mask) {
+            int bit = 31 - __builtin_clz(mask);
+            visit(i + bit);
+            mask &= ~(1u << bit);
+        }
+    }
+#endif
+    while (i > begin) {
+        i--;
+        if (data[i] != '.') visit(i);
+    }
+}
+
+class DenseRadar : public RadarEngine {
+public:
+    explicit DenseRadar(const ArenaGrid& grid) : grid(grid) {
+        int rows = grid.height(), cols = grid.width();
+        columns.resize(static_cast<size_t>(rows) * cols);
+        for (int r = 0; r < rows; r++) {
+            for (int c = 0; c < cols; c++) {
+                columns[column_index(r, c)] = grid.at(r, c);
+            }
+        }
+    }
+
+    const char* name() const override { return "dense"; }
+
+    void cell_changed(int row, int col, char, char after) override {
+        columns[column_index(row, col)] = after;
+    }
+
+    void scan(int row, int col, int direction, std::vector<RadarObj>& results,
+              std::pmr::memory_resource* scratch) override {
+        if (direction == 0) {
+            scan_neighbours(grid, row, col, results);
+            return;
+        }
+        auto [dr, dc] = directions[direction];
+        if (dr != 0 && dc != 0) {
+            walk_beam(grid, row, col, direction, results);  // diagonals are not contiguous in memory
+            return;
+        }
+
+        Lanes lanes(scratch);
+        for (int lane = -1; lane <= 1; lane++) {
+            std::pmr::vector<Hit>& hits = lanes.lane[lane + 1];
+            if (dr == 0) {
+                // a row of the grid
+                int r = row + lane;
+                if (r < 0 || r >= grid.height()) continue;
+                const char* cells = grid.row(r);
+                if (dc > 0) {
+                    for_each_object_up(cells, col + 1, grid.width(),
+                                       [&](int c) { hits.push_back({c - col, r, c}); });
+                } else {
+                    for_each_object_down(cells, 0, col,
+                                         [&](int c) { hits.push_back({col - c, r, c}); });
+                }
+            } else {
+                // a row of the column-major copy
+                int c = col + lane;
+                if (c < 0 || c >= grid.width()) continue;
+                const char* cells = columns.data() + column_index(0, c);
+                if (dr > 0) {
+                    for_each_object_up(cells, row + 1, grid.height(),
+                                       [&](int r) { hits.push_back({r - row, r, c}); });
+                } else {
+                    for_each_object_down(cells, 0, row,
+                                         [&](int r) { hits.push_back({row - r, r, c}); });
+                }
+            }
+        }
+        lanes.emit(grid, results);
+    }
+
+private:
+    const ArenaGrid& grid;
+    std::vector<char> columns;  // column-major copy of the grid
+
+    size_t column_index(int row, int col) const {
+        return static_cast<size_t>(col) * grid.height() + row;
+    }
+};
+
+// ---------------------------------------------------------------- sparse
+
+// Sorted positions of the objects on one line of the board.
+using Line = std::vector<int>;
+
+void line_insert(Line& line, int key) {
+    line.insert(std::lower_bound(line.begin(), line.end(), key), key);
+}
+
+void line_erase(Line& line, int key) {
+    auto it = std::lower_bound(line.begin(), line.end(), key);
+    if (it != line.end() && *it == key) line.erase(it);
+}
+
+class SparseRadar : public RadarEngine {
+public:
+    explicit SparseRadar(const ArenaGrid& grid)
+        : grid(grid),
+          by_row(grid.height()),
+          by_col(grid.width()),
+          by_diag(grid.height() + grid.width() - 1),
+          by_anti(grid.height() + grid.width() - 1) {
+        for (int r = 0; r < grid.height(); r++) {
+            for (int c = 0; c < grid.width(); c++) {
+                if (grid.at(r, c) != '.') add(r, c);
+            }
+        }
+    }
+
+    const char* name() const override { return "sparse"; }
+
+    void cell_changed(int row, int col, char before, char after) override {
+        if (before == '.' && after != '.') add(row, col);
+        else if (before != '.' && after == '.') remove(row, col);
+    }
+
+    void scan(int row, int col, int direction, std::vector<RadarObj>& results,
+              std::pmr::memory_resource* scratch) override {
+        if (direction == 0) {
+            scan_neighbours(grid, row, col, results);
+            return;
+        }
+        auto [dr, dc] = directions[direction];
+
+        Lanes lanes(scratch);
+        for (int lane = -1; lane <= 1; lane++) {
+            std::pmr::vector<Hit>& hits = lanes.lane[lane + 1];
+            if (dr == 0) {
+                int r = row + lane;
+                if (r < 0 || r >= grid.height()) continue;
+                walk_line(by_row[r], col, dc, [&](int c) {
+                    return Hit{(c - col) * dc, r, c};
+                }, hits);
+            } else if (dc == 0) {
+                int c = col + lane;
+                if (c < 0 || c >= grid.width()) continue;
+                walk_line(by_col[c], row, dr, [&](int r) {
+                    return Hit{(r - row) * dr, r, c};
+                }, hits);
+            } else {
+                // Diagonal lines are keyed by row. Lane -1 is the parallel line one
+                // row further along, lane +1 one column further along.
+                int line_row = row + (lane == -1 ? dr : 0);
+                int line_col = col + (lane == 1 ? dc : 0);
+                bool main_diagonal = (dr == dc);
+                int index = main_diagonal ? diag_index(line_row, line_col) : anti_index(line_row, line_col);
+                if (!line_exists(index)) continue;
+                const Line& line = main_diagonal ? by_diag[index] : by_anti[index];
+                int shift = line_col - line_row;  // col = row + shift on a main diagonal
+                int sum = line_row + line_col;    // col = sum - row on an anti-diagonal
+                walk_line(line, row, dr, [&](int r) {
+                    int c = main_diagonal ? r + shift : sum - r;
+                    int dist = (lane == -1) ? (c - col) * dc : (r - row) * dr;
+                    return Hit{dist, r, c};
+                }, hits);
+            }
+        }
+        lanes.emit(grid, results);
+    }
+
+private:
+    const ArenaGrid& grid;
+    std::vector<Line> by_row;   // columns of the objects in each row
+    std::vector<Line> by_col;   // rows of the objects in each column
+    std::vector<Line> by_diag;  // rows, per r - c
+    std::vector<Line> by_anti;  // rows, per r + c
+
+    int diag_index(int row, int col) const { return row - col + grid.width() - 1; }
+    int anti_index(int row, int col) const { return row + col; }
+
+    bool line_exists(int index) const { return index >= 0 && index < static_cast<int>(by_diag.size()); }
+
+    void add(int row, int col) {
+        line_insert(by_row[row], col);
+        line_insert(by_col[col], row);
+        line_insert(by_diag[diag_index(row, col)], row);
+        line_insert(by_anti[anti_index(row, col)], row);
+    }
+
+    void remove(int row, int col) {
+        line_erase(by_row[row], col);
+        line_erase(by_col[col], row);
+        line_erase(by_diag[diag_index(row, col)], row);
+        line_erase(by_anti[anti_index(row, col)], row);
+    }
+
+    // Walk a line away from `origin` in direction `step` (+1/-1), keeping the
+    // objects at least one step out. to_hit maps a key on the line to a Hit.
+    template <typename ToHit>
+    void walk_line(const Line& line, int origin, int step, ToHit to_hit, std::pmr::vector<Hit>& hits) const {
+        if (step > 0) {
+            for (auto it = std::lower_bound(line.begin(), line.end(), origin); it != line.end(); ++it) {
+                Hit hit = to_hit(*it);
+                if (hit.dist >= 1) hits.push_back(hit);
+            }
+        } else {
+            auto it = std::upper_bound(line.begin(), line.end(), origin);
+            while (it != line.begin()) {
+                --it;
+                Hit hit = to_hit(*it);
+                if (hit.dist >= 1) hits.push_back(hit);
+            }
+        }
+    }
+};
+
+} // namespace
+
+std::unique_ptr<RadarEngine> make_dense_radar(const ArenaGrid& grid) {
+    return std::make_unique<DenseRadar>(grid);
+}
+
+std::unique_ptr<RadarEngine> make_sparse_radar(const ArenaGrid& grid) {
+    return std::make_unique<SparseRadar>(grid);
+}
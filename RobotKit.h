@@ -0,0 +1,419 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "RobotBase.h"
+#include "RadarObj.h"
+
+// RobotKit: a world model and pathfinding for robot authors. Header-only, so a
+// robot just includes it - nothing extra to link.
+//
+//   OccupancyMap   what the robot has seen, one bit per cell per kind of object
+//   DistanceField  moves from every cell to the nearest goal (BFS), kept up to
+//                  date cheaply as the map learns new obstacles
+//   PathFinder     A* from here to one cell, with flames costing extra
+//
+// The map is a bitset per kind of object, in tiles; the searches work on flat
+// arrays indexed row * cols + col. All are sized from
+// m_board_row_max/m_board_col_max. Those are set when the robot is placed,
+// after its constructor has run, so call fit() from process_radar_results:
+//
+//     world.fit(m_board_row_max, m_board_col_max);
+//     world.observe(radar_results);
+//
+// Movement follows the arena: eight directions (see `directions`), mounds and
+// robots stop you, pits trap you for good, flames hurt but let you through.
+// Cells the robot has not seen are assumed empty.
+
+namespace robotkit {
+
+enum Layer { mound, pit, flame, robot, wreck, layer_count };
+
+class OccupancyMap
+{
+public:
+    // Resizes (and forgets everything) when the board size changed
+    void fit(int rows, int cols)
+    {
+        if (rows == m_rows && cols == m_cols) return;
+        m_rows = std::max(rows, 0);
+        m_cols = std::max(cols, 0);
+        m_tiles_across = (m_cols + 63) / 64;
+        size_t tiles = static_cast<size_t>((m_rows + 63) / 64) * m_tiles_across;
+        for (auto& layer : m_tiles) layer.assign(tiles, 0);
+        m_words.clear();
+        m_robot_cells.clear();
+        m_learned.clear();
+    }
+
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+    bool in_bounds(int row, int col) const { return row >= 0 && row < m_rows && col >= 0 && col < m_cols; }
+    int index(int row, int col) const { return row * m_cols + col; }
+
+    // Records one radar scan. Mounds, pits, flames and wrecks stay known for
+    // good; the robot layer holds only the robots in this latest scan.
+    void observe(const std::vector<RadarObj>& radar_results)
+    {
+        for (auto [row, col] : m_robot_cells) clear(robot, row, col);
+        m_robot_cells.clear();
+        m_learned.clear();
+
+        for (const auto& obj : radar_results)
+        {
+            if (!in_bounds(obj.m_row, obj.m_col)) continue;
+            switch (obj.m_type)
+            {
+                case 'M': learn(mound, obj.m_row, obj.m_col); break;
+                case 'P': learn(pit, obj.m_row, obj.m_col); break;
+                case 'F': learn(flame, obj.m_row, obj.m_col); break;
+                case 'X': set(wreck, obj.m_row, obj.m_col); break;
+                case 'R':
+                    set(robot, obj.m_row, obj.m_col);
+                    m_robot_cells.push_back({obj.m_row, obj.m_col});
+                    break;
+                default: break;
+            }
+        }
+    }
+
+    bool has(Layer layer, int row, int col) const { return in_bounds(row, col) && bit(layer, row, col); }
+
+    // Known mound, pit or flame: the kinds of cell a careful robot stays off
+    bool obstacle(int row, int col) const
+    {
+        return in_bounds(row, col) && (bit(mound, row, col) || bit(pit, row, col) || bit(flame, row, col));
+    }
+
+    // Cells (row * cols + col) that became known mounds, pits or flames in the
+    // latest observe()
+    const std::vector<int>& learned() const { return m_learned; }
+
+    // No bounds checks from here on
+    bool bit(Layer layer, int row, int col) const
+    {
+        uint32_t tile = m_tiles[layer][tile_index(row, col)];
+        return tile && (m_words[tile - 1 + (row & 63)] >> (col & 63)) & 1;
+    }
+
+    void set(Layer layer, int row, int col)
+    {
+        uint32_t& tile = m_tiles[layer][tile_index(row, col)];
+        if (!tile)
+        {
+            tile = static_cast<uint32_t>(m_words.size() + 1);
+            m_words.resize(m_words.size() + 64, 0);
+        }
+        m_words[tile - 1 + (row & 63)] |= uint64_t(1) << (col & 63);
+    }
+
+    void clear(Layer layer, int row, int col)
+    {
+        uint32_t tile = m_tiles[layer][tile_index(row, col)];
+        if (tile) m_words[tile - 1 + (row & 63)] &= ~(uint64_t(1) << (col & 63));
+    }
+
+private:
+    // 64x64 cells, one word per row. A tile is added to the pool when
+    // something is first seen in it, so a robot that has scanned a few beams
+    // of a huge board holds a few kilobytes, not a bitmap of the whole board.
+    int m_rows = 0;
+    int m_cols = 0;
+    int m_tiles_across = 0;
+    std::vector<uint32_t> m_tiles[layer_count];  // offset of the tile in m_words + 1, 0 = none yet
+    std::vector<uint64_t> m_words;
+    std::vector<std::pair<int, int>> m_robot_cells;
+    std::vector<int> m_learned;
+
+    size_t tile_index(int row, int col) const { return static_cast<size_t>(row >> 6) * m_tiles_across + (col >> 6); }
+
+    void learn(Layer layer, int row, int col)
+    {
+        if (bit(layer, row, col)) return;
+        set(layer, row, col);
+        m_learned.push_back(index(row, col));
+    }
+};
+
+// Move `distance` steps in `direction` (1-8)
+struct Move
+{
+    int direction = 0;
+    int distance = 0;
+};
+
+// Distance in moves from every cell to the nearest goal cell, avoiding known
+// mounds and pits (and flames unless avoid_flames is off). Steer by next_move().
+class DistanceField
+{
+public:
+    static constexpr int unreachable = -1;
+
+    bool avoid_flames = true;
+
+    void compute(const OccupancyMap& map, const std::vector<std::pair<int, int>>& goals)
+    {
+        m_rows = map.rows();
+        m_cols = map.cols();
+        m_goals.clear();
+        for (auto [row, col] : goals)
+        {
+            if (map.in_bounds(row, col)) m_goals.push_back(map.index(row, col));
+        }
+        search(map);
+    }
+
+    // Brings the field up to date with the obstacles map.observe() just
+    // learned. A new obstacle only matters if some cell's shortest path went
+    // through it; when every cell one step further out has another way in at
+    // the same distance, nothing changes and no search is needed. Returns true
+    // if the field had to be recomputed.
+    bool update(const OccupancyMap& map)
+    {
+        if (map.rows() != m_rows || map.cols() != m_cols)
+        {
+            compute(map, {});
+            return true;
+        }
+        for (int cell : map.learned())
+        {
+            if (!blocked(map, cell / m_cols, cell % m_cols) || m_dist[cell] == unreachable) continue;
+            if (!bypassable(map, cell))
+            {
+                search(map);
+                return true;
+            }
+            m_dist[cell] = unreachable;
+        }
+        return false;
+    }
+
+    int distance(int row, int col) const
+    {
+        if (row < 0 || row >= m_rows || col < 0 || col >= m_cols) return unreachable;
+        return m_dist[row * m_cols + col];
+    }
+
+    // The first leg of a shortest way to a goal: the neighbour one step
+    // closer, then on in the same direction while each step still gets closer,
+    // up to max_distance. Distance 0 when at a goal or cut off from all goals.
+    Move next_move(int row, int col, int max_distance) const
+    {
+        Move move;
+        int here = distance(row, col);
+        if (here <= 0) return move;
+
+        // Neighbours of a reachable cell are at most one move closer
+        for (int dir = 1; dir <= 8 && move.direction == 0; dir++)
+        {
+            if (distance(row + directions[dir].first, col + directions[dir].second) == here - 1) move.direction = dir;
+        }
+        if (move.direction == 0) return move;
+
+        auto [dr, dc] = directions[move.direction];
+        while (move.distance < max_distance)
+        {
+            int d = distance(row + dr * (move.distance + 1), col + dc * (move.distance + 1));
+            if (d == unreachable || d != here - move.distance - 1) break;
+            move.distance++;
+        }
+        return move;
+    }
+
+private:
+    int m_rows = 0;
+    int m_cols = 0;
+    std::vector<int> m_goals;
+    std::vector<int> m_dist;
+    std::vector<int> m_queue;
+
+    bool blocked(const OccupancyMap& map, int row, int col) const
+    {
+        return map.bit(mound, row, col) || map.bit(pit, row, col) || (avoid_flames && map.bit(flame, row, col));
+    }
+
+    template <typename Visit>
+    void for_each_neighbour(int cell, Visit visit) const
+    {
+        int row = cell / m_cols, col = cell % m_cols;
+        for (int dir = 1; dir <= 8; dir++)
+        {
+            int r = row + directions[dir].first, c = col + directions[dir].second;
+            if (r >= 0 && r < m_rows && c >= 0 && c < m_cols) visit(r, c, r * m_cols + c);
+        }
+    }
+
+    // Does every cell that was reached through `cell` have another neighbour
+    // at the same distance as `cell`?
+    bool bypassable(const OccupancyMap& map, int cell) const
+    {
+        int level = m_dist[cell];
+        if (level == 0) return false;  // a goal itself
+        bool ok = true;
+        for_each_neighbour(cell, [&](int, int, int next) {
+            if (!ok || m_dist[next] != level + 1) return;
+            bool other_way = false;
+            for_each_neighbour(next, [&](int r, int c, int prev) {
+                other_way = other_way || (prev != cell && m_dist[prev] == level && !blocked(map, r, c));
+            });
+            ok = other_way;
+        });
+        return ok;
+    }
+
+    void search(const OccupancyMap& map)
+    {
+        m_dist.assign(static_cast<size_t>(m_rows) * m_cols, unreachable);
+        m_queue.clear();
+        for (int goal : m_goals)
+        {
+            if (m_dist[goal] == unreachable)
+            {
+                m_dist[goal] = 0;
+                m_queue.push_back(goal);
+            }
+        }
+        for (size_t head = 0; head < m_queue.size(); head++)
+        {
+            int cell = m_queue[head];
+            int next_dist = m_dist[cell] + 1;
+            for_each_neighbour(cell, [&](int r, int c, int next) {
+                if (m_dist[next] == unreachable && !blocked(map, r, c))
+                {
+                    m_dist[next] = next_dist;
+                    m_queue.push_back(next);
+                }
+            });
+        }
+    }
+};
+
+// A* from one cell to another. Steps cost 1, onto a known flame flame_cost
+// (0 = never); mounds and pits are impassable, and so are robots from the
+// latest scan when robots_block is on. The goal itself may be occupied, e.g.
+// by the robot being chased. Scratch arrays are kept between searches and
+// never cleared: a generation stamp tells which entries are current.
+class PathFinder
+{
+public:
+    int flame_cost = 5;
+    bool robots_block = true;
+
+    // First leg of the cheapest path, as DistanceField::next_move. Distance 0
+    // when no path is known.
+    Move first_move(const OccupancyMap& map, int row, int col, int goal_row, int goal_col, int max_distance)
+    {
+        Move move;
+        if (!map.in_bounds(row, col) || !map.in_bounds(goal_row, goal_col) || (row == goal_row && col == goal_col))
+            return move;
+
+        size_t cells = static_cast<size_t>(map.rows()) * map.cols();
+        if (m_stamp.size() != cells)
+        {
+            m_cost.assign(cells, 0);
+            m_parent.assign(cells, -1);
+            m_stamp.assign(cells, 0);
+            m_generation = 0;
+        }
+        if (++m_generation == 0)
+        {
+            std::fill(m_stamp.begin(), m_stamp.end(), 0);
+            m_generation = 1;
+        }
+
+        int start = map.index(row, col), goal = map.index(goal_row, goal_col);
+        auto heuristic = [&](int cell) {
+            return std::max(std::abs(cell / map.cols() - goal_row), std::abs(cell % map.cols() - goal_col));
+        };
+        // Min-heap of (cost + heuristic, cell) on a vector kept between searches
+        auto& open = m_heap;
+        auto later = std::greater<std::pair<int, int>>();
+        auto push = [&](int estimate, int cell) {
+            open.push_back({estimate, cell});
+            std::push_heap(open.begin(), open.end(), later);
+        };
+        open.clear();
+        visit(start, 0, -1);
+        push(heuristic(start), start);
+
+        bool found = false;
+        while (!open.empty())
+        {
+            std::pop_heap(open.begin(), open.end(), later);
+            auto [estimate, cell] = open.back();
+            open.pop_back();
+            if (cell == goal)
+            {
+                found = true;
+                break;
+            }
+            if (estimate - heuristic(cell) > m_cost[cell]) continue;  // stale entry
+
+            int r = cell / map.cols(), c = cell % map.cols();
+            for (int dir = 1; dir <= 8; dir++)
+            {
+                int nr = r + directions[dir].first, nc = c + directions[dir].second;
+                if (!map.in_bounds(nr, nc)) continue;
+                int next = map.index(nr, nc);
+                int step = next == goal ? 1 : step_cost(map, nr, nc);
+                if (step == 0) continue;
+                int cost = m_cost[cell] + step;
+                if (m_stamp[next] != m_generation || cost < m_cost[next])
+                {
+                    visit(next, cost, cell);
+                    push(cost + heuristic(next), next);
+                }
+            }
+        }
+        if (!found) return move;
+
+        // Walk back to the cell after the start, then measure the straight run
+        auto& path = m_path;
+        path.clear();
+        for (int cell = goal; cell != start; cell = m_parent[cell]) path.push_back(cell);
+        std::reverse(path.begin(), path.end());
+
+        int first_row = path[0] / map.cols(), first_col = path[0] % map.cols();
+        int dr = first_row - row, dc = first_col - col;
+        for (int dir = 1; dir <= 8; dir++)
+        {
+            if (directions[dir].first == dr && directions[dir].second == dc) move.direction = dir;
+        }
+        while (move.distance < max_distance && move.distance < static_cast<int>(path.size()) &&
+               path[move.distance] == map.index(row + dr * (move.distance + 1), col + dc * (move.distance + 1)))
+        {
+            move.distance++;
+        }
+        return move;
+    }
+
+private:
+    std::vector<int> m_cost;
+    std::vector<int> m_parent;
+    std::vector<uint32_t> m_stamp;
+    uint32_t m_generation = 0;
+    std::vector<std::pair<int, int>> m_heap;
+    std::vector<int> m_path;
+
+    void visit(int cell, int cost, int parent)
+    {
+        m_stamp[cell] = m_generation;
+        m_cost[cell] = cost;
+        m_parent[cell] = parent;
+    }
+
+    int step_cost(const OccupancyMap& map, int row, int col) const
+    {
+        if (map.bit(mound, row, col) || map.bit(pit, row, col)) return 0;
+        if (robots_block && map.bit(robot, row, col)) return 0;
+        if (map.bit(flame, row, col)) return flame_cost;
+        return 1;
+    }
+};
+
+} // namespace robotkit
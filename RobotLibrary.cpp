@@ -0,0 +1,192 @@
+#include "RobotLibrary.h"
+#ifdef ROBOTWARZ_STATIC_ROBOTS
+#include "StaticRobots.h"
+#endif
+#include <algorithm>
+#include <dlfcn.h>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <unistd.h>
+
+namespace {
+
+std::mutex registry_mutex;
+std::map<std::string, std::weak_ptr<const RobotLibrary>> registry;  // every robot acquired so far
+std::vector<RobotLibraries::Ref> pinned;
+bool pinned_everything = false;          // pin({}) ran: the robots here are fixed for the process
+
+#ifndef ROBOTWARZ_STATIC_ROBOTS
+// What a robot source can include from the arena
+const char* const robot_headers[] = {"RobotBase.h", "RadarObj.h", "RobotPlanner.h", "RobotRadar.h", "RobotKit.h"};
+
+void compile_robot(const std::string& cpp_file) {
+    std::string robot_name = cpp_file.substr(6, cpp_file.length() - 10); // Strip "Robot_" and ".cpp"
+    std::string so_file = "lib" + robot_name + ".so";
+
+    // Up to date: newer than its inputs - the source, RobotBase.o and every
+    // header a robot can include (those present; the same set the static
+    // build's robot objects depend on). The headers fix the layouts shared
+    // across dlopen, so a stale library would not match them. Tournament
+    // workers load the same robots match after match and should not rebuild
+    // them every time.
+    std::error_code so_ec, cpp_ec, base_ec;
+    auto built = std::filesystem::last_write_time(so_file, so_ec);
+    auto source = std::filesystem::last_write_time(cpp_file, cpp_ec);
+    auto base = std::filesystem::last_write_time("RobotBase.o", base_ec);
+    bool up_to_date = !so_ec && !cpp_ec && !base_ec && built >= source && built >= base;
+    for (const char* header : robot_headers) {
+        std::error_code header_ec;
+        auto changed = std::filesystem::last_write_time(header, header_ec);
+        if (!header_ec && changed > built) up_to_date = false;
+    }
+    if (up_to_date) return;
+
+    // Build under a private name and rename into place, so another process
+    // sharing this directory never dlopens a half-written library.
+    std::string tmp_file = so_file + "." + std::to_string(getpid()) + ".tmp";
+    std::string cmd = "g++ -std=c++20 -fPIC -shared " + cpp_file + " RobotBase.o -o " + tmp_file;
+    std::cout << "Compiling " << cpp_file << " to " << so_file << "...\n";
+
+    int result = system(cmd.c_str());
+    if (result != 0) {
+        std::cerr << "Failed to compile " << cpp_file << "\n";
+        std::error_code ec;
+        std::filesystem::remove(tmp_file, ec);
+        return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_file, so_file, ec);
+    if (ec) {
+        std::cerr << "Could not install " << so_file << ": " << ec.message() << "\n";
+    }
+}
+
+RobotLibrary* load_library(const std::string& name) {
+    compile_robot("Robot_" + name + ".cpp");
+
+    // RTLD_NOW: every symbol is resolved here, once, not lazily in each arena
+    std::string so_file = "./lib" + name + ".so";
+    void* handle = dlopen(so_file.c_str(), RTLD_NOW);
+    if (!handle) {
+        std::cerr << "Failed to load " << so_file << ": " << dlerror() << "\n";
+        return nullptr;
+    }
+
+    auto create = (RobotFactory)dlsym(handle, "create_robot");
+    if (!create) {
+        std::cerr << "Failed to find create_robot in " << so_file << "\n";
+        dlclose(handle);
+        return nullptr;
+    }
+
+    // Optional: robots that plan a whole turn at once, and robots that take
+    // their radar as bitmasks (RobotRadar.h)
+    auto library = new RobotLibrary;
+    library->name = name;
+    library->create = create;
+    library->planner = (TurnPlannerLookup)dlsym(handle, "get_turn_planner");
+    library->beam_receiver = (RadarBeamReceiverLookup)dlsym(handle, "get_radar_beam_receiver");
+    library->handle = handle;
+    return library;
+}
+#else
+RobotLibrary* load_library(const std::string& name) {
+    // Linked into this binary: nothing to compile or dlopen
+    for (const auto& entry : static_robots) {
+        if (entry.name == name) {
+            return new RobotLibrary{name, entry.create, entry.planner, entry.beam_receiver, nullptr};
+        }
+    }
+    std::cerr << "Robot " << name << " is not built into this binary\n";
+    return nullptr;
+}
+#endif
+
+} // namespace
+
+std::vector<std::string> RobotLibraries::available(const std::vector<std::string>& roster) {
+    std::vector<std::string> names;
+#ifdef ROBOTWARZ_STATIC_ROBOTS
+    for (const auto& entry : static_robots) {
+        std::string name(entry.name);
+        if (roster.empty() || std::find(roster.begin(), roster.end(), name) != roster.end()) {
+            names.push_back(name);
+        }
+    }
+    for (const auto& name : roster) {
+        if (std::find(names.begin(), names.end(), name) == names.end()) {
+            std::cerr << "Robot " << name << " is not built into this binary\n";
+        }
+    }
+#else
+    {
+        // Pinned robots are fixed for the process: no need to list the directory
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        auto is_pinned = [](const std::string& name) {
+            return std::any_of(pinned.begin(), pinned.end(), [&](const Ref& library) { return library->name == name; });
+        };
+        if (roster.empty() ? pinned_everything : std::all_of(roster.begin(), roster.end(), is_pinned)) {
+            for (const auto& library : pinned) {
+                if (roster.empty() || std::find(roster.begin(), roster.end(), library->name) != roster.end()) {
+                    names.push_back(library->name);
+                }
+            }
+            // In Robot_<Name>.cpp order, as below
+            std::sort(names.begin(), names.end(), [](const std::string& a, const std::string& b) {
+                return a + ".cpp" < b + ".cpp";
+            });
+            names.erase(std::unique(names.begin(), names.end()), names.end());
+            return names;
+        }
+    }
+    std::vector<std::string> robot_files;
+    for (const auto& entry : std::filesystem::directory_iterator(".")) {
+        std::string filename = entry.path().filename().string();
+        if (filename.substr(0, 6) == "Robot_" && filename.substr(filename.length() - 4) == ".cpp") {
+            std::string robot_name = filename.substr(6, filename.length() - 10);
+            if (roster.empty() || std::find(roster.begin(), roster.end(), robot_name) != roster.end()) {
+                robot_files.push_back(filename);
+            }
+        }
+    }
+
+    // Directory order is unspecified; sort so a seed always gives the same roster order
+    std::sort(robot_files.begin(), robot_files.end());
+    for (const auto& filename : robot_files) {
+        names.push_back(filename.substr(6, filename.length() - 10));
+    }
+#endif
+    return names;
+}
+
+RobotLibraries::Ref RobotLibraries::acquire(const std::string& name) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::weak_ptr<const RobotLibrary>& entry = registry[name];
+    if (Ref library = entry.lock()) return library;
+
+    RobotLibrary* loaded = load_library(name);
+    if (!loaded) return nullptr;
+    // The last reference unloads the code; the robots made from it are gone by then
+    Ref library(loaded, [](const RobotLibrary* library) {
+        if (library->handle) dlclose(library->handle);
+        delete library;
+    });
+    entry = library;
+    return library;
+}
+
+int RobotLibraries::pin(const std::vector<std::string>& roster) {
+    int loaded = 0;
+    for (const auto& name : available(roster)) {
+        Ref library = acquire(name);
+        if (!library) continue;
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        pinned.push_back(library);
+        loaded++;
+    }
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    if (roster.empty()) pinned_everything = true;
+    return loaded;
+}
@@ -0,0 +1,46 @@
+#ifndef ROBOT_LIBRARY_H
+#define ROBOT_LIBRARY_H
+
+#include "RobotBase.h"
+#include "RobotPlanner.h"
+#include "RobotRadar.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// A robot's code with its entry points resolved: create makes a new robot.
+struct RobotLibrary {
+    std::string name;                     // "Blaster" for Robot_Blaster.cpp
+    RobotFactory create = nullptr;
+    TurnPlannerLookup planner = nullptr;  // null unless the robot exports get_turn_planner
+    RadarBeamReceiverLookup beam_receiver = nullptr;  // null unless it exports get_radar_beam_receiver
+    void* handle = nullptr;               // from dlopen; null for robots linked into the binary
+};
+
+// The process-wide registry of robot libraries. The first acquire of a robot
+// compiles lib<Name>.so if it is out of date, dlopens it and looks up its
+// entry points; every later one, from any arena on any thread, gets the same
+// library back with no filesystem or dlopen work at all. Each reference keeps
+// the code loaded - an arena holds one per robot until the robot is deleted -
+// and the library is dlclosed when the last goes. In the static build the
+// registry hands out the robots linked in (StaticRobots.h).
+class RobotLibraries {
+public:
+    using Ref = std::shared_ptr<const RobotLibrary>;
+
+    // The robots of the roster that can be played here (every one if it is
+    // empty), sorted by name so a seed always gives the same roster order.
+    // Once they are pinned, the directory is not listed again.
+    static std::vector<std::string> available(const std::vector<std::string>& roster);
+
+    // Null if the robot cannot be built or loaded; the reason is on stderr
+    static Ref acquire(const std::string& name);
+
+    // Acquire these robots (empty = every one) for the life of the process,
+    // so arenas created afterwards - also in forked children - find them
+    // loaded. Robots added to the directory later are not picked up. Returns
+    // how many are.
+    static int pin(const std::vector<std::string>& roster);
+};
+
+#endif // ROBOT_LIBRARY_H
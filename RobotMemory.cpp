@@ -0,0 +1,142 @@
+#include "RobotMemory.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Sits right in front of every block handed out. `offset` is the distance back
+// to what malloc/aligned_alloc returned.
+struct alignas(16) BlockHeader {
+    uint64_t size;
+    uint32_t slot;
+    uint32_t offset;
+};
+static_assert(sizeof(BlockHeader) == 16, "header must keep malloc's 16-byte alignment");
+
+struct Slot {
+    std::atomic<int64_t> current{0};
+    std::atomic<int64_t> peak{0};
+    std::atomic<int64_t> quota{0};
+    std::atomic<bool> over_quota{false};
+    std::atomic<bool> claimed{false};
+};
+
+// Plain arrays of atomics: constant-initialized, so usable from operator new
+// before any constructor has run.
+Slot slots[RobotMemory::max_slots];
+thread_local int active_slot = 0;
+
+void* allocate(std::size_t size, std::size_t align, bool nothrow) {
+    int slot = active_slot;
+    Slot& account = slots[slot];
+    int64_t quota = account.quota.load(std::memory_order_relaxed);
+    if (quota > 0 && account.current.load(std::memory_order_relaxed) + static_cast<int64_t>(size) > quota) {
+        account.over_quota.store(true, std::memory_order_relaxed);
+        if (nothrow) return nullptr;
+        throw std::bad_alloc();
+    }
+
+    std::size_t offset = align > sizeof(BlockHeader) ? align : sizeof(BlockHeader);
+    void* base = nullptr;
+    if (align > sizeof(BlockHeader)) {
+        std::size_t total = (size + offset + align - 1) / align * align;
+        base = std::aligned_alloc(align, total);
+    } else {
+        base = std::malloc(size + offset);
+    }
+    if (!base) {
+        if (nothrow) return nullptr;
+        throw std::bad_alloc();
+    }
+
+    char* user = static_cast<char*>(base) + offset;
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(user) - 1;
+    header->size = size;
+    header->slot = static_cast<uint32_t>(slot);
+    header->offset = static_cast<uint32_t>(offset);
+
+    int64_t now = account.current.fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t peak = account.peak.load(std::memory_order_relaxed);
+    while (now > peak && !account.peak.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+    return user;
+}
+
+void deallocate(void* ptr) {
+    if (!ptr) return;
+    BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+    slots[header->slot].current.fetch_sub(header->size, std::memory_order_relaxed);
+    std::free(static_cast<char*>(ptr) - header->offset);
+}
+
+} // namespace
+
+int RobotMemory::claim_slot() {
+    for (int slot = 1; slot < max_slots; slot++) {
+        bool expected = false;
+        if (slots[slot].claimed.compare_exchange_strong(expected, true)) {
+            slots[slot].current = 0;
+            slots[slot].peak = 0;
+            slots[slot].quota = 0;
+            slots[slot].over_quota = false;
+            return slot;
+        }
+    }
+    return 0;
+}
+
+void RobotMemory::release_slot(int slot) {
+    if (slot <= 0 || slot >= max_slots) return;
+    slots[slot].quota = 0;
+    slots[slot].claimed = false;
+}
+
+int64_t RobotMemory::current_bytes(int slot) { return slots[slot].current.load(); }
+int64_t RobotMemory::peak_bytes(int slot) { return slots[slot].peak.load(); }
+int64_t RobotMemory::quota(int slot) { return slots[slot].quota.load(); }
+bool RobotMemory::over_quota(int slot) { return slot > 0 && slots[slot].over_quota.load(); }
+
+void RobotMemory::set_quota(int slot, int64_t bytes) {
+    if (slot > 0) slots[slot].quota = bytes;
+}
+
+RobotMemoryScope::RobotMemoryScope(int slot) : previous(active_slot) {
+    active_slot = slot;
+}
+
+RobotMemoryScope::~RobotMemoryScope() {
+    active_slot = previous;
+}
+
+// ---------------------------------------------------------------- replacements
+
+void* operator new(std::size_t size) { return allocate(size, 0, false); }
+void* operator new[](std::size_t size) { return allocate(size, 0, false); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0, true); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0, true); }
+void* operator new(std::size_t size, std::align_val_t align) {
+    return allocate(size, static_cast<std::size_t>(align), false);
+}
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return allocate(size, static_cast<std::size_t>(align), false);
+}
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<std::size_t>(align), true);
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<std::size_t>(align), true);
+}
+
+void operator delete(void* ptr) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(ptr); }
@@ -0,0 +1,46 @@
+#ifndef ROBOT_MEMORY_H
+#define ROBOT_MEMORY_H
+
+#include <cstdint>
+
+// Heap accounting per robot. RobotWarz replaces the global operator new and
+// delete, and the robot libraries it dlopens resolve to them too. Every block
+// carries a small header naming the slot that was active on the allocating
+// thread, so a block is charged to the robot whose call allocated it and
+// credited back to that robot whenever and wherever it is freed. The arena
+// activates a robot's slot (RobotMemoryScope) only around calls into the robot.
+//
+// A slot can have a quota: an allocation that would take it over fails with
+// std::bad_alloc (or nullptr for nothrow new) and marks the slot over quota,
+// which the arena treats as grounds for disqualification. Memory a robot gets
+// straight from malloc is not seen.
+class RobotMemory {
+public:
+    static constexpr int max_slots = 64;  // slot 0 is the engine and everything untagged
+
+    // A free slot with zeroed counters, or 0 if all are taken (robot untracked).
+    static int claim_slot();
+    static void release_slot(int slot);
+
+    static int64_t current_bytes(int slot);
+    static int64_t peak_bytes(int slot);
+
+    static void set_quota(int slot, int64_t bytes);  // 0 = unlimited
+    static int64_t quota(int slot);
+    static bool over_quota(int slot);
+};
+
+// Charges allocations on this thread to `slot` while in scope.
+class RobotMemoryScope {
+public:
+    explicit RobotMemoryScope(int slot);
+    ~RobotMemoryScope();
+
+    RobotMemoryScope(const RobotMemoryScope&) = delete;
+    RobotMemoryScope& operator=(const RobotMemoryScope&) = delete;
+
+private:
+    int previous;
+};
+
+#endif // ROBOT_MEMORY_H
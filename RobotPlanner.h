@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include "RobotBase.h"
+
+// Optional extension to RobotBase for robots that do heavy thinking.
+//
+// A robot that implements TurnPlanner makes its whole decision for a turn in one
+// call, which the arena can run on a worker thread while other robots - ones that
+// cannot hit it or change anything its radar sees - take their turns. The result
+// is exactly what the robot would have decided playing strictly in turn order.
+//
+// Rules for a planning robot, since its code may run at the same time as other robots:
+//   * only read and write this robot's own members (get_current_location,
+//     get_move_speed, get_health etc. are fine),
+//   * don't call the final RobotBase setters (move_to, take_damage, ...) from plan_turn,
+//   * don't use shared state such as static variables (rand() is fine: each
+//     robot draws from its own stream, see RobotRandom.h).
+//
+// get_radar_direction is still called on its own, before plan_turn, on the
+// arena's thread - possibly a little before the robot's turn comes up.
+
+// What a robot does with its turn: fire at (shot_row, shot_col), or move.
+struct TurnPlan
+{
+    bool shoot = false;
+    int shot_row = 0;
+    int shot_col = 0;
+    int move_direction = 0;
+    int move_distance = 0;
+};
+
+class TurnPlanner
+{
+public:
+    virtual ~TurnPlanner() = default;
+
+    // Equivalent to process_radar_results, then get_shot_location, then (only
+    // when not shooting) get_move_direction.
+    virtual TurnPlan plan_turn(const std::vector<RadarObj>& radar_results) = 0;
+};
+
+// A planning robot exports this next to create_robot, returning itself:
+//
+//   extern "C" TurnPlanner* get_turn_planner(RobotBase* robot)
+//   {
+//       return dynamic_cast<TurnPlanner*>(robot);
+//   }
+typedef TurnPlanner* (*TurnPlannerLookup)(RobotBase*);
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+
+#include "RobotBase.h"
+
+// Optional compact radar for robots (robot API v2).
+//
+// Instead of a vector of RadarObj, a robot that implements RadarBeamReceiver
+// gets its scan as a RadarBeam: one bitmask per kind of object per lane of the
+// beam, pointing into storage the arena reuses - nothing is allocated and
+// there are no structs to walk. process_radar_beam is called in place of
+// process_radar_results; everything else about the turn is unchanged, and
+// robots that don't opt in keep getting process_radar_results. A robot that
+// also plans its turns (RobotPlanner.h) is given the vector in plan_turn.
+//
+// A beam is three lanes wide. Step s (1..length) of lane -1, 0 or +1 is the
+// cell beam_cell(s, lane) returns: the centre lane runs straight out in the
+// radar direction, and the side lanes sit beside it - for a diagonal beam
+// lane -1 is one further along the row direction and lane +1 one further
+// along the column direction. length stops where the centre lane leaves the
+// board; side-lane bits are only set for cells on the board. Direction 0 is
+// the 3x3 block around the robot: step 1-3 is the row above, the robot's own
+// row and the row below, and the lane is the column offset.
+enum RadarBeamType { beam_robot, beam_wreck, beam_mound, beam_pit, beam_flame, beam_type_count };
+
+struct RadarBeam
+{
+    int row = 0;               // the scanning robot, where the beam starts
+    int col = 0;
+    int direction = 0;
+    int length = 0;            // steps in the beam
+    int words = 0;             // uint64_t words per lane mask: (length + 63) / 64
+    const uint64_t* masks = nullptr;  // beam_type_count x 3 lanes x words
+
+    // Bit s - 1 is step s of the lane (-1, 0 or +1)
+    const uint64_t* lane_mask(RadarBeamType type, int lane) const
+    {
+        return masks + (type * 3 + lane + 1) * words;
+    }
+
+    bool seen(RadarBeamType type, int step, int lane) const
+    {
+        return (lane_mask(type, lane)[(step - 1) >> 6] >> ((step - 1) & 63)) & 1;
+    }
+
+    void beam_cell(int step, int lane, int& cell_row, int& cell_col) const
+    {
+        if (direction == 0)
+        {
+            cell_row = row + step - 2;
+            cell_col = col + lane;
+            return;
+        }
+        int dr = directions[direction].first;
+        int dc = directions[direction].second;
+        cell_row = row + dr * step;
+        cell_col = col + dc * step;
+        if (dr == 0) cell_row += lane;
+        else if (dc == 0) cell_col += lane;
+        else if (lane == -1) cell_row += dr;
+        else if (lane == 1) cell_col += dc;
+    }
+
+    // Calls visit(row, col) for every object of `type`, nearest first and at
+    // equal distance lane -1, 0, +1 - the order process_radar_results sees.
+    template <typename Visit>
+    void for_each(RadarBeamType type, Visit visit) const
+    {
+        const uint64_t* lanes[3] = {lane_mask(type, -1), lane_mask(type, 0), lane_mask(type, 1)};
+        for (int w = 0; w < words; w++)
+        {
+            uint64_t any = lanes[0][w] | lanes[1][w] | lanes[2][w];
+            while (any)
+            {
+                int step = w * 64 + __builtin_ctzll(any) + 1;
+                uint64_t bit = any & -any;
+                for (int lane = -1; lane <= 1; lane++)
+                {
+                    if (lanes[lane + 1][w] & bit)
+                    {
+                        int cell_row, cell_col;
+                        beam_cell(step, lane, cell_row, cell_col);
+                        visit(cell_row, cell_col);
+                    }
+                }
+                any &= any - 1;
+            }
+        }
+    }
+};
+
+class RadarBeamReceiver
+{
+public:
+    virtual ~RadarBeamReceiver() = default;
+
+    virtual void process_radar_beam(const RadarBeam& beam) = 0;
+};
+
+// A robot opts in by exporting this next to create_robot, returning itself:
+//
+//   extern "C" RadarBeamReceiver* get_radar_beam_receiver(RobotBase* robot)
+//   {
+//       return dynamic_cast<RadarBeamReceiver*>(robot);
+//   }
+typedef RadarBeamReceiver* (*RadarBeamReceiverLookup)(RobotBase*);
@@ -0,0 +1,57 @@
+#include "RobotRandom.h"
+#include <cstdlib>
+#include <mutex>
+
+namespace {
+
+// splitmix64: one add and a mix per draw, and any state is a good one
+uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Constant-initialized, so usable before any constructor has run
+thread_local RobotRandom* active_stream = nullptr;
+RobotRandom shared_stream;
+std::mutex shared_stream_mutex;
+
+} // namespace
+
+void RobotRandom::seed(unsigned seed, uint64_t index) {
+    state = mix(static_cast<uint64_t>(seed) << 32 | (index & 0xFFFFFFFFu));
+}
+
+void RobotRandom::seed(unsigned value) {
+    state = mix(value);
+}
+
+int RobotRandom::next() {
+    state += 0x9E3779B97F4A7C15ull;
+    return static_cast<int>(mix(state) % (static_cast<uint64_t>(RAND_MAX) + 1));
+}
+
+RobotRandomScope::RobotRandomScope(RobotRandom* stream) : previous(active_stream) {
+    active_stream = stream;
+}
+
+RobotRandomScope::~RobotRandomScope() {
+    active_stream = previous;
+}
+
+// ---------------------------------------------------------------- replacements
+
+int rand() noexcept {
+    if (RobotRandom* stream = active_stream) return stream->next();
+    std::lock_guard<std::mutex> lock(shared_stream_mutex);
+    return shared_stream.next();
+}
+
+void srand(unsigned seed) noexcept {
+    if (RobotRandom* stream = active_stream) {
+        stream->seed(seed);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(shared_stream_mutex);
+    shared_stream.seed(seed);
+}
@@ -0,0 +1,37 @@
+#ifndef ROBOT_RANDOM_H
+#define ROBOT_RANDOM_H
+
+#include <cstdint>
+
+// rand() and srand() per robot. RobotWarz defines both, and the robot
+// libraries it dlopens resolve to them rather than to the C library's, the
+// same way they resolve to RobotMemory's operator new. While a robot's stream
+// is active on a thread (RobotRandomScope), its draws come from that stream
+// alone: what a robot rolls depends on the match seed and its own calls, not
+// on which robots drew before it or on which thread it runs. Outside any
+// scope - the engine, a robot's constructor - rand() draws from one shared
+// stream, as the C library's does.
+class RobotRandom {
+public:
+    void seed(unsigned seed, uint64_t index);  // roster slot `index` of a match played from `seed`
+    void seed(unsigned value);                 // what srand does
+    int next();                                // 0 to RAND_MAX
+
+private:
+    uint64_t state = 0;
+};
+
+// Sends rand() and srand() on this thread to `stream` while in scope.
+class RobotRandomScope {
+public:
+    explicit RobotRandomScope(RobotRandom* stream);
+    ~RobotRandomScope();
+
+    RobotRandomScope(const RobotRandomScope&) = delete;
+    RobotRandomScope& operator=(const RobotRandomScope&) = delete;
+
+private:
+    RobotRandom* previous;
+};
+
+#endif // ROBOT_RANDOM_H
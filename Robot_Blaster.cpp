@@ -1,9 +1,11 @@
 #include "RobotBase.h"
+#include "RobotRadar.h"
 #include <vector>
 #include <cmath>
 #include <cstdlib>
 
-class Robot_Blaster : public RobotBase
+// Takes its radar as bitmasks (RobotRadar.h): it only ever looks for robots.
+class Robot_Blaster : public RobotBase, public RadarBeamReceiver
 {
 private:
     int target_row;
@@ -29,22 +31,25 @@ public:
 
     void process_radar_results(const std::vector<RadarObj>& radar_results) override {
         has_target = false;
-        
-        // Find closest robot
+        for (const auto& obj : radar_results) {
+            if (obj.m_type == 'R') consider_target(obj.m_row, obj.m_col);
+        }
+    }
+
+    void process_radar_beam(const RadarBeam& beam) override {
+        has_target = false;
+        beam.for_each(beam_robot, [this](int row, int col) { consider_target(row, col); });
+    }
+
+    // Keep the closest robot seen this scan
+    void consider_target(int row, int col) {
         int curr_row, curr_col;
         get_current_location(curr_row, curr_col);
-        int closest_dist = 9999;
-        
-        for (const auto& obj : radar_results) {
-            if (obj.m_type == 'R') {
-                int dist = abs(obj.m_row - curr_row) + abs(obj.m_col - curr_col);
-                if (dist < closest_dist) {
-                    closest_dist = dist;
-                    target_row = obj.m_row;
-                    target_col = obj.m_col;
-                    has_target = true;
-                }
-            }
+        int dist = abs(row - curr_row) + abs(col - curr_col);
+        if (!has_target || dist < abs(target_row - curr_row) + abs(target_col - curr_col)) {
+            target_row = row;
+            target_col = col;
+            has_target = true;
         }
     }
 
@@ -102,3 +107,7 @@ public:
 extern "C" RobotBase* create_robot() {
     return new Robot_Blaster();
 }
+
+extern "C" RadarBeamReceiver* get_radar_beam_receiver(RobotBase* robot) {
+    return dynamic_cast<RadarBeamReceiver*>(robot);
+}
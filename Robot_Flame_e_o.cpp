@@ -1,7 +1,7 @@
 #include "RobotBase.h"
+#include "RobotKit.h"
 #include <cstdlib>
 #include <ctime>
-#include <set>
 #include <cmath>
 #include <limits>
 #include <utility>
@@ -16,7 +16,8 @@ private:
     int radar_direction = 1; // Radar scanning direction (1-8)
     bool fixed_radar = false; // Tracks whether radar is locked on a target
     const int max_range = 4; // Maximum range of the flamethrower
-    std::set<std::pair<int, int>> obstacles_memory; // Memory of obstacles
+    robotkit::OccupancyMap obstacles_memory; // Memory of obstacles
+    robotkit::PathFinder paths; // Detours around them
 
     // Helper function to calculate Manhattan distance
     int calculate_distance(int row1, int col1, int row2, int col2) const 
@@ -50,24 +51,20 @@ private:
     // Update the memory of obstacles
     void update_obstacle_memory(const std::vector<RadarObj>& radar_results) 
     {
-        for (const auto& obj : radar_results) 
-        {
-            if (obj.m_type == 'M' || obj.m_type == 'P' || obj.m_type == 'F') 
-            {
-                obstacles_memory.insert({obj.m_row, obj.m_col});
-            }
-        }
+        obstacles_memory.fit(m_board_row_max, m_board_col_max);
+        obstacles_memory.observe(radar_results);
     }
 
     // Check if a cell is passable
     bool is_passable(int row, int col) const 
     {
-        return obstacles_memory.find({row, col}) == obstacles_memory.end();
+        return !obstacles_memory.obstacle(row, col);
     }
 
 public:
     Robot_Flame_e_o() : RobotBase(2, 5, flamethrower) 
     {
+        paths.flame_cost = 0; // Never walk through flames
         std::srand(static_cast<unsigned int>(std::time(nullptr))); // Seed for random movement
     }
 
@@ -158,9 +155,12 @@ public:
             } 
             else 
             {
-                // Stay in place if movement is blocked
-                move_direction = 0;
-                move_distance = 0;
+                // Both direct steps are blocked: take the first step of a path
+                // around the obstacles (stays in place if there is none)
+                robotkit::Move detour = paths.first_move(obstacles_memory, current_row, current_col,
+                                                         target_row, target_col, 1);
+                move_direction = detour.direction;
+                move_distance = detour.distance;
             }
 
             return;
@@ -1,25 +1,18 @@
 #include "RobotBase.h"
+#include "RobotPlanner.h"
+#include "RobotKit.h"
 #include <vector>
 #include <iostream>
-#include <algorithm> // For std::find_if
+#include <algorithm>
 
-class Robot_Ratboy : public RobotBase 
+class Robot_Ratboy : public RobotBase, public TurnPlanner 
 {
 private:
     bool m_moving_down = true; // Tracks vertical movement direction
     int to_shoot_row = -1;   // Tracks the row of the next target to shoot
     int to_shoot_col = -1;   // Tracks the column of the next target to shoot
     
-    std::vector<RadarObj> known_obstacles; // Permanent obstacle list
-
-    // Helper function to determine if a cell is an obstacle
-    bool is_obstacle(int row, int col) const 
-    {
-        return std::any_of(known_obstacles.begin(), known_obstacles.end(), 
-                           [&](const RadarObj& obj) {
-                               return obj.m_row == row && obj.m_col == col;
-                           });
-    }
+    robotkit::OccupancyMap known_obstacles; // Permanent obstacle memory, a bit per cell
 
     // Clears the target when no enemy is found
     void clear_target() 
@@ -28,16 +21,6 @@ private:
         to_shoot_col = -1;
     }
 
-    // Helper function to add an obstacle to the list if it's not already there
-    void add_obstacle(const RadarObj& obj) 
-    {
-        if (obj.m_type == 'M' || obj.m_type == 'P' || obj.m_type == 'F' && 
-            !is_obstacle(obj.m_row, obj.m_col)) 
-        {
-            known_obstacles.push_back(obj);
-        }
-    }
-
 public:
     Robot_Ratboy() : RobotBase(3, 4, railgun) {} // Initialize with 3 movement, 4 armor, railgun
 
@@ -56,11 +39,12 @@ public:
     {
         clear_target();
 
+        // Add static obstacles to the obstacle memory
+        known_obstacles.fit(m_board_row_max, m_board_col_max);
+        known_obstacles.observe(radar_results);
+
         for (const auto& obj : radar_results) 
         {
-            // Add static obstacles to the obstacle list
-            add_obstacle(obj);
-
             // Identify the first enemy found as the target
             if (obj.m_type == 'R' && to_shoot_row == -1 && to_shoot_col == -1) 
             {
@@ -83,6 +67,19 @@ public:
         return false;
     }
 
+    // Whole turn in one call, so the arena can let Ratboy think during other robots' turns
+    virtual TurnPlan plan_turn(const std::vector<RadarObj>& radar_results) override 
+    {
+        TurnPlan plan;
+        process_radar_results(radar_results);
+        plan.shoot = get_shot_location(plan.shot_row, plan.shot_col);
+        if (!plan.shoot) 
+        {
+            get_move_direction(plan.move_direction, plan.move_distance);
+        }
+        return plan;
+    }
+
     // Determines the next movement direction
 void get_move_direction(int& move_direction, int& move_distance) override 
 {
@@ -139,4 +136,10 @@ void get_move_direction(int& move_direction, int& move_distance) override
 extern "C" RobotBase* create_robot() 
 {
     return new Robot_Ratboy();
-}
\ No newline at end of file
+}
+
+// Lets the arena find Ratboy's TurnPlanner side
+extern "C" TurnPlanner* get_turn_planner(RobotBase* robot) 
+{
+    return dynamic_cast<TurnPlanner*>(robot);
+}
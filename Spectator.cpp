@@ -0,0 +1,373 @@
+#include "Spectator.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t frame_header = 9;       // length, kind, round
+constexpr int view_rows = 40;            // the viewer draws at most this much of the board
+constexpr int view_cols = 60;
+
+void put_u32(std::string& out, uint32_t value) { out.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+void put_i32(std::string& out, int32_t value) { out.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+
+void put_robot_state(std::string& out, const SpectatorRobot& robot) {
+    put_i32(out, robot.health);
+    put_i32(out, robot.armor);
+    put_i32(out, robot.row);
+    put_i32(out, robot.col);
+}
+
+// Frame header with a placeholder length, filled in by end_frame
+std::string begin_frame(char kind, int round) {
+    std::string frame;
+    put_u32(frame, 0);
+    frame.push_back(kind);
+    put_u32(frame, static_cast<uint32_t>(round));
+    return frame;
+}
+
+std::shared_ptr<const std::string> end_frame(std::string& frame) {
+    uint32_t body = static_cast<uint32_t>(frame.size() - frame_header);
+    std::memcpy(frame.data(), &body, sizeof(body));
+    return std::make_shared<const std::string>(std::move(frame));
+}
+
+bool same_state(const SpectatorRobot& a, const SpectatorRobot& b) {
+    return a.health == b.health && a.armor == b.armor && a.row == b.row && a.col == b.col;
+}
+
+sockaddr_un socket_address(const std::string& path, bool& fits) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    fits = path.size() < sizeof(address.sun_path);
+    if (fits) std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------- broadcast
+
+SpectatorBroadcast::~SpectatorBroadcast() {
+    for (auto& viewer : connections) close(viewer.fd);
+    if (listener >= 0) {
+        close(listener);
+        unlink(path.c_str());
+    }
+}
+
+bool SpectatorBroadcast::open(const std::string& socket_path) {
+    path = socket_path;
+    bool fits;
+    sockaddr_un address = socket_address(path, fits);
+    if (!fits) {
+        std::cerr << "Broadcast socket path too long: " << path << "\n";
+        return false;
+    }
+    listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    unlink(path.c_str());
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, 64) != 0) {
+        std::cerr << "Cannot broadcast on " << path << ": " << strerror(errno) << "\n";
+        if (listener >= 0) close(listener);
+        listener = -1;
+        return false;
+    }
+    return true;
+}
+
+void SpectatorBroadcast::cell_changed(int row, int col) {
+    if (cols == 0) return;               // nothing published yet; the first keyframe has it
+    uint32_t index = static_cast<uint32_t>(row) * cols + col;
+    if (!is_dirty[index]) {
+        is_dirty[index] = true;
+        dirty.push_back(index);
+    }
+}
+
+void SpectatorBroadcast::accept_viewers() {
+    for (;;) {
+        int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;                      // EAGAIN: nobody else waiting
+        }
+        Viewer viewer;
+        viewer.fd = fd;
+        connections.push_back(std::move(viewer));
+    }
+}
+
+void SpectatorBroadcast::publish(int round, const ArenaGrid& grid, const std::vector<SpectatorRobot>& robots) {
+    if (listener < 0) return;
+    if (cols != grid.width() || is_dirty.size() != static_cast<size_t>(grid.height()) * grid.width()) {
+        cols = grid.width();
+        is_dirty.assign(static_cast<size_t>(grid.height()) * cols, false);
+        dirty.clear();
+        last_robots.clear();
+    }
+    accept_viewers();
+
+    Frame changes = delta(round, grid, robots);
+    Frame whole;
+    for (auto& viewer : connections) {
+        if (viewer.queued > max_backlog) {
+            // Behind: skip ahead to a keyframe, keeping only a frame already half sent
+            while (viewer.queue.size() > (viewer.sent > 0 ? 1u : 0u)) viewer.queue.pop_back();
+            viewer.queued = viewer.queue.empty() ? 0 : viewer.queue.front()->size() - viewer.sent;
+            viewer.needs_keyframe = true;
+            if (++viewer.skips > max_skips) {
+                close(viewer.fd);
+                viewer.fd = -1;
+                continue;
+            }
+        }
+        if (viewer.needs_keyframe) {
+            if (!whole) whole = keyframe(round, grid, robots);
+            queue_frame(viewer, whole);
+            viewer.needs_keyframe = false;
+        } else {
+            queue_frame(viewer, changes);
+        }
+    }
+
+    for (auto& viewer : connections) {
+        if (viewer.fd >= 0 && !drain(viewer)) {
+            close(viewer.fd);
+            viewer.fd = -1;
+        }
+    }
+    connections.erase(std::remove_if(connections.begin(), connections.end(), [](const Viewer& v) { return v.fd < 0; }),
+                      connections.end());
+}
+
+void SpectatorBroadcast::finish(int round, const std::string& result) {
+    if (listener < 0) return;
+    std::string frame = begin_frame('E', round);
+    frame += result;
+    Frame end = end_frame(frame);
+    for (auto& viewer : connections) {
+        queue_frame(viewer, end);
+        drain(viewer);                   // one try; a viewer that is behind misses the end
+    }
+}
+
+SpectatorBroadcast::Frame SpectatorBroadcast::keyframe(int round, const ArenaGrid& grid,
+                                                       const std::vector<SpectatorRobot>& robots) const {
+    std::string frame = begin_frame('K', round);
+    put_u32(frame, static_cast<uint32_t>(grid.height()));
+    put_u32(frame, static_cast<uint32_t>(grid.width()));
+    for (int r = 0; r < grid.height(); r++) frame.append(grid.row(r), grid.width());
+    put_u32(frame, static_cast<uint32_t>(robots.size()));
+    for (const auto& robot : robots) {
+        frame.push_back(robot.symbol);
+        size_t length = std::min<size_t>(robot.name.size(), 255);
+        frame.push_back(static_cast<char>(length));
+        frame.append(robot.name, 0, length);
+        put_robot_state(frame, robot);
+    }
+    return end_frame(frame);
+}
+
+SpectatorBroadcast::Frame SpectatorBroadcast::delta(int round, const ArenaGrid& grid,
+                                                    const std::vector<SpectatorRobot>& robots) {
+    std::string frame = begin_frame('D', round);
+    put_u32(frame, static_cast<uint32_t>(dirty.size()));
+    for (uint32_t index : dirty) {
+        put_u32(frame, index);
+        frame.push_back(grid.at(index / cols, index % cols));
+        is_dirty[index] = false;
+    }
+    dirty.clear();
+
+    size_t count_at = frame.size();
+    uint32_t changed = 0;
+    put_u32(frame, 0);
+    for (size_t i = 0; i < robots.size(); i++) {
+        if (i < last_robots.size() && same_state(robots[i], last_robots[i])) continue;
+        put_u32(frame, static_cast<uint32_t>(i));
+        put_robot_state(frame, robots[i]);
+        changed++;
+    }
+    std::memcpy(frame.data() + count_at, &changed, sizeof(changed));
+    last_robots = robots;
+    return end_frame(frame);
+}
+
+void SpectatorBroadcast::queue_frame(Viewer& viewer, const Frame& frame) {
+    if (viewer.fd < 0) return;
+    viewer.queue.push_back(frame);
+    viewer.queued += frame->size();
+}
+
+bool SpectatorBroadcast::drain(Viewer& viewer) {
+    while (!viewer.queue.empty()) {
+        const std::string& frame = *viewer.queue.front();
+        ssize_t n = send(viewer.fd, frame.data() + viewer.sent, frame.size() - viewer.sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (n <= 0) return false;
+        viewer.sent += n;
+        viewer.queued -= n;
+        if (viewer.sent == frame.size()) {
+            viewer.queue.pop_front();
+            viewer.sent = 0;
+        }
+    }
+    viewer.skips = 0;                    // caught up
+    return true;
+}
+
+// ---------------------------------------------------------------- viewer
+
+namespace {
+
+bool read_exactly(int fd, void* data, size_t size) {
+    char* out = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t n = read(fd, out, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        out += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Reads fixed-size fields from a frame body
+struct Fields {
+    const char* at;
+    const char* end;
+
+    template <typename T>
+    bool get(T& value) {
+        if (end - at < static_cast<long>(sizeof(T))) return false;
+        std::memcpy(&value, at, sizeof(T));
+        at += sizeof(T);
+        return true;
+    }
+
+    bool get_state(SpectatorRobot& robot) {
+        return get(robot.health) && get(robot.armor) && get(robot.row) && get(robot.col);
+    }
+};
+
+void draw(int round, int rows, int cols, const std::vector<char>& cells, const std::vector<SpectatorRobot>& robots) {
+    std::string out = "\x1b[H\x1b[2J";
+    out += "Round " + std::to_string(round) + "   board " + std::to_string(rows) + "x" + std::to_string(cols);
+    if (rows > view_rows || cols > view_cols) {
+        out += " (showing the top-left " + std::to_string(std::min(rows, view_rows)) + "x" +
+               std::to_string(std::min(cols, view_cols)) + ")";
+    }
+    out += "\n\n";
+
+    std::vector<std::string> view(std::min(rows, view_rows), std::string());
+    for (int r = 0; r < static_cast<int>(view.size()); r++) {
+        for (int c = 0; c < std::min(cols, view_cols); c++) {
+            char cell = cells[static_cast<size_t>(r) * cols + c];
+            view[r] += cell == 'R' ? " R?" : std::string("  ") + cell;
+        }
+    }
+    for (const auto& robot : robots) {
+        if (robot.row >= 0 && robot.row < static_cast<int>(view.size()) && robot.col >= 0 && robot.col < view_cols &&
+            robot.col < cols) {
+            view[robot.row][robot.col * 3 + 1] = robot.health > 0 ? 'R' : 'X';
+            view[robot.row][robot.col * 3 + 2] = robot.symbol;
+        }
+    }
+    for (const auto& line : view) out += line + "\n";
+
+    out += "\n";
+    for (const auto& robot : robots) {
+        out += std::string(1, robot.symbol) + " " + robot.name + "  health " + std::to_string(robot.health) +
+               "  armor " + std::to_string(robot.armor) + "  at (" + std::to_string(robot.row) + "," +
+               std::to_string(robot.col) + ")" + (robot.health > 0 ? "" : "  DESTROYED") + "\n";
+    }
+    std::cout << out << std::flush;
+}
+
+} // namespace
+
+int watch_match(const std::string& socket_path) {
+    bool fits;
+    sockaddr_un address = socket_address(socket_path, fits);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (!fits || fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "Cannot connect to " << socket_path << ": " << strerror(errno) << "\n";
+        if (fd >= 0) close(fd);
+        return 1;
+    }
+
+    int rows = 0, cols = 0;
+    std::vector<char> cells;
+    std::vector<SpectatorRobot> robots;
+    std::vector<char> body;
+    bool have_board = false;
+    for (;;) {
+        uint32_t length, round;
+        char kind;
+        if (!read_exactly(fd, &length, sizeof(length)) || !read_exactly(fd, &kind, 1) ||
+            !read_exactly(fd, &round, sizeof(round))) {
+            std::cout << "\nThe arena went away.\n";
+            break;
+        }
+        body.resize(length);
+        if (!read_exactly(fd, body.data(), length)) break;
+        Fields in{body.data(), body.data() + body.size()};
+
+        if (kind == 'E') {
+            std::cout << "\n" << std::string(body.begin(), body.end()) << "\n";
+            close(fd);
+            return 0;
+        }
+        bool ok = true;
+        if (kind == 'K') {
+            uint32_t r, c, count;
+            ok = in.get(r) && in.get(c) && uint64_t(r) * c <= uint64_t(in.end - in.at);
+            if (ok) {
+                rows = static_cast<int>(r);
+                cols = static_cast<int>(c);
+                cells.assign(in.at, in.at + size_t(r) * c);
+                in.at += size_t(r) * c;
+                ok = in.get(count);
+            }
+            robots.clear();
+            for (uint32_t i = 0; ok && i < count; i++) {
+                SpectatorRobot robot;
+                uint8_t name_length = 0;
+                ok = in.get(robot.symbol) && in.get(name_length) && in.end - in.at >= name_length;
+                if (!ok) break;
+                robot.name.assign(in.at, name_length);
+                in.at += name_length;
+                ok = in.get_state(robot);
+                robots.push_back(robot);
+            }
+            have_board = ok;
+        } else if (kind == 'D' && have_board) {
+            uint32_t count, index;
+            ok = in.get(count);
+            for (uint32_t i = 0; ok && i < count; i++) {
+                char cell;
+                ok = in.get(index) && in.get(cell) && index < cells.size();
+                if (ok) cells[index] = cell;
+            }
+            ok = ok && in.get(count);
+            for (uint32_t i = 0; ok && i < count; i++) {
+                ok = in.get(index) && index < robots.size() && in.get_state(robots[index]);
+            }
+        }
+        if (!ok) {
+            std::cerr << "Garbled frame from the arena\n";
+            break;
+        }
+        if (have_board) draw(static_cast<int>(round), rows, cols, cells, robots);
+    }
+    close(fd);
+    return 1;
+}
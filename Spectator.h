@@ -0,0 +1,86 @@
+#ifndef SPECTATOR_H
+#define SPECTATOR_H
+
+#include "ArenaGrid.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Live match broadcast to any number of viewer processes over a Unix socket.
+//
+// A viewer that connects gets a keyframe - the whole board and every robot -
+// and then one delta frame per round: the cells that changed and the robots
+// whose health, armor or position did. Viewers attach and detach whenever
+// they like. Nothing here ever blocks the arena: sockets are non-blocking,
+// frames are shared between viewers, and a viewer that falls more than
+// max_backlog behind skips ahead - its queued deltas are dropped for a fresh
+// keyframe. One that still cannot keep up after max_skips keyframes in a row
+// is disconnected.
+//
+// Frames: uint32 body length, a kind byte ('K' keyframe, 'D' delta, 'E' end
+// of match), uint32 round, then the body. Integers are in host byte order;
+// the socket is local.
+//   K: uint32 rows, cols, the rows * cols cells, uint32 robot count, and per
+//      robot its symbol, uint8 name length, name, then int32 health, armor, row, col.
+//   D: uint32 cell count, (uint32 row * cols + col, cell) each, uint32 robot
+//      count, (uint32 robot index, int32 health, armor, row, col) each.
+//   E: the result line.
+struct SpectatorRobot {
+    std::string name;
+    char symbol = '?';
+    int health = 0;
+    int armor = 0;
+    int row = 0;
+    int col = 0;
+};
+
+class SpectatorBroadcast {
+public:
+    static constexpr size_t max_backlog = 1 << 20;   // bytes queued per viewer
+    static constexpr int max_skips = 8;
+
+    ~SpectatorBroadcast();
+    bool open(const std::string& socket_path);
+
+    // Whenever a board cell changes
+    void cell_changed(int row, int col);
+    // After each round (and once before the first): take in new viewers and
+    // send everyone what changed.
+    void publish(int round, const ArenaGrid& grid, const std::vector<SpectatorRobot>& robots);
+    void finish(int round, const std::string& result);
+
+    size_t viewers() const { return connections.size(); }
+
+private:
+    using Frame = std::shared_ptr<const std::string>;
+    struct Viewer {
+        int fd = -1;
+        std::deque<Frame> queue;
+        size_t sent = 0;                 // bytes of queue.front() already out
+        size_t queued = 0;               // bytes in queue, less sent
+        bool needs_keyframe = true;
+        int skips = 0;
+    };
+
+    std::string path;
+    int listener = -1;
+    std::vector<Viewer> connections;
+    int cols = 0;
+    std::vector<uint32_t> dirty;         // changed cells since the last frame
+    std::vector<bool> is_dirty;
+    std::vector<SpectatorRobot> last_robots;
+
+    void accept_viewers();
+    Frame keyframe(int round, const ArenaGrid& grid, const std::vector<SpectatorRobot>& robots) const;
+    Frame delta(int round, const ArenaGrid& grid, const std::vector<SpectatorRobot>& robots);
+    void queue_frame(Viewer& viewer, const Frame& frame);
+    bool drain(Viewer& viewer);          // false once the viewer is gone
+};
+
+// The terminal viewer: connect to a broadcasting arena and draw the match
+// until it ends. Returns the exit status.
+int watch_match(const std::string& socket_path);
+
+#endif // SPECTATOR_H
@@ -0,0 +1,46 @@
+#ifndef STATIC_ROBOTS_H
+#define STATIC_ROBOTS_H
+
+#include "RobotBase.h"
+#include "RobotPlanner.h"
+#include "RobotRadar.h"
+#include <string_view>
+
+// Robots compiled straight into the binary by `make RobotWarz_static`. Each
+// Robot_<Name>.cpp is built with create_robot renamed to create_robot_<Name>
+// (and get_turn_planner and get_radar_beam_receiver likewise), and StaticRoster.inc,
+// generated from STATIC_ROBOTS, lists them as ROBOT(<Name>) lines. With LTO
+// over robots and arena together, the robot calls no longer cross a dlopen
+// boundary and can be inlined and devirtualized.
+
+#define ROBOT(Name)                                    \
+    extern "C" RobotBase* create_robot_##Name();       \
+    extern "C" __attribute__((weak)) TurnPlanner* get_turn_planner_##Name(RobotBase*); \
+    extern "C" __attribute__((weak)) RadarBeamReceiver* get_radar_beam_receiver_##Name(RobotBase*);
+#include "StaticRoster.inc"
+#undef ROBOT
+
+struct StaticRobot {
+    std::string_view name;
+    RobotBase* (*create)();
+    TurnPlannerLookup planner;  // null unless the robot exports get_turn_planner
+    RadarBeamReceiverLookup beam_receiver;  // null unless it exports get_radar_beam_receiver
+};
+
+constexpr StaticRobot static_robots[] = {
+#define ROBOT(Name) {#Name, create_robot_##Name, get_turn_planner_##Name, get_radar_beam_receiver_##Name},
+#include "StaticRoster.inc"
+#undef ROBOT
+};
+
+// load_robots takes them in this order, which must match the sorted Robot_*.cpp
+// order of the plugin build for a seed to replay the same match.
+constexpr bool static_roster_sorted() {
+    for (size_t i = 1; i < std::size(static_robots); i++) {
+        if (!(static_robots[i - 1].name < static_robots[i].name)) return false;
+    }
+    return true;
+}
+static_assert(static_roster_sorted(), "StaticRoster.inc must list robots sorted by name");
+
+#endif // STATIC_ROBOTS_H
@@ -0,0 +1,611 @@
+#include "Tournament.h"
+#include "Arena.h"
+#include "AnalyticsStore.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+bool split_address(const std::string& address, std::string& host, std::string& port) {
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos || colon + 1 == address.size()) {
+        std::cerr << "Expected host:port, got " << address << "\n";
+        return false;
+    }
+    host = address.substr(0, colon);
+    port = address.substr(colon + 1);
+    return true;
+}
+
+bool send_all(int fd, const std::string& text) {
+    size_t sent = 0;
+    while (sent < text.size()) {
+        ssize_t n = send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+// One recv (blocking until data arrives), split into complete lines. false on
+// end of stream or error.
+bool receive_lines(int fd, std::string& pending, std::deque<std::string>& lines) {
+    char buffer[4096];
+    ssize_t n;
+    do {
+        n = recv(fd, buffer, sizeof(buffer), 0);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) return false;
+
+    pending.append(buffer, n);
+    size_t start = 0, end;
+    while ((end = pending.find('\n', start)) != std::string::npos) {
+        lines.push_back(pending.substr(start, end - start));
+        start = end + 1;
+    }
+    pending.erase(0, start);
+    return true;
+}
+
+std::string host_name() {
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0) return "unknown";
+    return name;
+}
+
+// A finished match, one line, for the console and the results file
+std::string describe(const MatchSpec& spec, const MatchResult& result) {
+    std::ostringstream line;
+    line << "match " << spec.id << " ";
+    for (size_t i = 0; i < spec.robots.size(); i++) {
+        line << (i ? "," : "") << spec.robots[i];
+    }
+    line << " seed " << spec.seed << ": ";
+    if (result.outcome == "winner") line << "winner " << result.winner;
+    else if (!result.winner.empty()) line << result.outcome << ", winner " << result.winner;
+    else line << result.outcome;
+    if (result.outcome != "crashed") line << " after " << result.rounds << " rounds";
+    return line.str();
+}
+
+// Plays one match in this process with the console silenced.
+MatchResult play_match(std::istream& config) {
+    std::ofstream discard("/dev/null");
+    std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+    MatchResult result;
+    {
+        Arena arena;
+        if (arena.initialize(config)) {
+            arena.run();
+            result = arena.match_result();
+        } else {
+            result.outcome = "crashed";  // its map is unusable
+        }
+    }
+    std::cout.rdbuf(console);
+    return result;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------- coordinator
+
+bool TournamentCoordinator::load(const std::string& tournament_file) {
+    std::ifstream file(tournament_file);
+    if (!file.is_open()) {
+        std::cerr << "Could not open tournament file " << tournament_file << "\n";
+        return false;
+    }
+
+    std::string key, value;
+    while (file >> key >> value) {
+        if (key == "listen") listen_address = value;
+        else if (key == "local_workers") local_workers = std::stoi(value);
+        else if (key == "fork_server") fork_server = (value == "yes");
+        else if (key == "group_size") group_size = std::max(1, std::stoi(value));
+        else if (key == "matches_per_group") matches_per_group = std::max(1, std::stoi(value));
+        else if (key == "first_seed") first_seed = static_cast<unsigned>(std::stoul(value));
+        else if (key == "max_attempts") max_attempts = std::max(1, std::stoi(value));
+        else if (key == "match_timeout") match_timeout = std::max(1, std::stoi(value));
+        else if (key == "arena_config") arena_config = value;
+        else if (key == "results_file") results_file = value;
+        else if (key == "analytics_file") analytics = std::make_unique<AnalyticsWriter>(value);
+        else if (key == "robots") {
+            std::istringstream names(value);
+            std::string name;
+            while (std::getline(names, name, ',')) roster.push_back(name);
+        }
+    }
+
+    // Every match plays with the arena config, except for what the tournament decides
+    std::ifstream config(arena_config);
+    if (!config.is_open()) {
+        std::cerr << "Could not open " << arena_config << ", matches use the arena defaults\n";
+    }
+    while (config >> key >> value) {
+        if (key == "watch_live" || key == "seed" || key == "robots" || key == "analytics_file") continue;
+        base_config += key + " " + value + "\n";
+    }
+    return true;
+}
+
+void TournamentCoordinator::find_roster() {
+    if (!roster.empty()) return;
+    for (const auto& entry : std::filesystem::directory_iterator(".")) {
+        std::string filename = entry.path().filename().string();
+        if (filename.substr(0, 6) == "Robot_" && filename.substr(filename.length() - 4) == ".cpp") {
+            roster.push_back(filename.substr(6, filename.length() - 10));
+        }
+    }
+}
+
+// Every group_size-robot combination of the roster, matches_per_group times
+void TournamentCoordinator::build_matches() {
+    find_roster();
+    std::sort(roster.begin(), roster.end());
+    int size = std::min<int>(group_size, roster.size());
+    if (size == 0) return;
+
+    std::vector<bool> chosen(roster.size(), false);
+    std::fill(chosen.begin(), chosen.begin() + size, true);
+    do {
+        std::vector<std::string> group;
+        for (size_t i = 0; i < roster.size(); i++) {
+            if (chosen[i]) group.push_back(roster[i]);
+        }
+        for (int m = 0; m < matches_per_group; m++) {
+            MatchSpec spec;
+            spec.id = static_cast<int>(matches.size()) + 1;
+            spec.robots = group;
+            spec.seed = first_seed + m;
+            matches.push_back(spec);
+        }
+    } while (std::prev_permutation(chosen.begin(), chosen.end()));
+
+    results.assign(matches.size(), MatchResult());
+    for (size_t i = 0; i < matches.size(); i++) {
+        queue.push_back(static_cast<int>(i));
+    }
+}
+
+int TournamentCoordinator::open_listener(int& port) {
+    std::string host, service;
+    if (!split_address(listen_address, host, service)) return -1;
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* found = nullptr;
+    if (int rc = getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &found)) {
+        std::cerr << "Cannot listen on " << listen_address << ": " << gai_strerror(rc) << "\n";
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo* ai = found; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) != 0 || listen(fd, 64) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(found);
+    if (fd < 0) {
+        std::cerr << "Cannot listen on " << listen_address << ": " << strerror(errno) << "\n";
+        return -1;
+    }
+
+    // port 0 asks the kernel for a free one
+    sockaddr_storage bound = {};
+    socklen_t length = sizeof(bound);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&bound), &length);
+    char port_text[NI_MAXSERV];
+    getnameinfo(reinterpret_cast<sockaddr*>(&bound), length, nullptr, 0, port_text, sizeof(port_text), NI_NUMERICSERV);
+    port = std::stoi(port_text);
+    return fd;
+}
+
+void TournamentCoordinator::spawn_worker(int port) {
+    std::string host, service;
+    split_address(listen_address, host, service);
+    if (host.empty() || host == "0.0.0.0") host = "127.0.0.1";
+    else if (host == "::") host = "::1";
+    std::string address = host + ":" + std::to_string(port);
+
+    std::cout.flush();  // or the child inherits and repeats unwritten output
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::cerr << "Could not start a worker: " << strerror(errno) << "\n";
+        return;
+    }
+    if (pid == 0) {
+        if (fork_server) {
+            // Keep the preloaded robots; drop the coordinator's sockets
+            close(listener);
+            for (const auto& worker : connections) close(worker.fd);
+            int status = TournamentWorker(address).run();
+            std::cout.flush();
+            _exit(status);
+        }
+        execl("/proc/self/exe", "RobotWarz", "--worker", address.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    local_pids.insert(pid);
+    spawns_left--;
+}
+
+// Collect local workers that exited and start replacements while work remains
+void TournamentCoordinator::reap_workers(int port) {
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        if (!local_pids.erase(pid)) continue;
+        if (WIFSIGNALED(status)) {
+            std::cerr << "Worker " << pid << " killed by signal " << WTERMSIG(status) << "\n";
+        } else if (WEXITSTATUS(status) != 0) {
+            std::cerr << "Worker " << pid << " exited with status " << WEXITSTATUS(status) << "\n";
+        }
+        if (finished < static_cast<int>(matches.size()) && spawns_left > 0) {
+            spawn_worker(port);
+        }
+    }
+}
+
+bool TournamentCoordinator::handle_line(Connection& worker, const std::string& line) {
+    std::istringstream fields(line);
+    std::string tag;
+    fields >> tag;
+
+    if (worker.name.empty()) {
+        std::string host;
+        pid_t pid = -1;
+        if (tag != "hello" || !(fields >> host >> pid)) return false;
+        worker.name = host + ":" + std::to_string(pid);
+        if (host == host_name() && local_pids.count(pid)) worker.pid = pid;
+        return true;
+    }
+
+    if (worker.in_result) {
+        if (line != "end") {
+            worker.result.read_line(line);
+            return true;
+        }
+        worker.in_result = false;
+        int index = worker.playing;
+        worker.playing = -1;
+        record(index, worker.result, worker.name);
+        return true;
+    }
+
+    int id;
+    if (tag != "result" || !(fields >> id) || worker.playing < 0 || matches[worker.playing].id != id) {
+        return false;
+    }
+    worker.in_result = true;
+    worker.result = MatchResult();
+    return true;
+}
+
+// Hand queued matches to idle workers
+void TournamentCoordinator::dispatch() {
+    for (auto& worker : connections) {
+        if (queue.empty()) return;
+        if (worker.fd < 0 || worker.name.empty() || worker.playing >= 0) continue;
+
+        int index = queue.front();
+        queue.pop_front();
+        const MatchSpec& spec = matches[index];
+
+        std::ostringstream message;
+        message << "match " << spec.id << "\n" << base_config << "watch_live no\nseed " << spec.seed << "\nrobots ";
+        for (size_t i = 0; i < spec.robots.size(); i++) {
+            message << (i ? "," : "") << spec.robots[i];
+        }
+        message << "\nend\n";
+
+        worker.playing = index;
+        worker.deadline = std::chrono::steady_clock::now() + std::chrono::seconds(match_timeout);
+        if (!send_all(worker.fd, message.str())) {
+            lose(worker, "disconnected");
+        }
+    }
+}
+
+// Drop a worker. Its match, if any, goes back to the front of the queue.
+void TournamentCoordinator::lose(Connection& worker, const std::string& reason) {
+    close(worker.fd);
+    worker.fd = -1;
+    if (worker.playing < 0) return;
+
+    int index = worker.playing;
+    worker.playing = -1;
+    MatchSpec& spec = matches[index];
+    spec.attempts++;
+    std::cerr << "Worker " << (worker.name.empty() ? "?" : worker.name) << " " << reason
+              << " during match " << spec.id << " (attempt " << spec.attempts << " of " << max_attempts << ")\n";
+
+    if (spec.attempts >= max_attempts) {
+        MatchResult crashed;
+        crashed.outcome = "crashed";
+        record(index, crashed, worker.name);
+    } else {
+        queue.push_front(index);
+    }
+}
+
+void TournamentCoordinator::record(int index, const MatchResult& result, const std::string& worker) {
+    results[index] = result;
+    finished++;
+
+    std::string line = describe(matches[index], result);
+    std::cout << "[" << finished << "/" << matches.size() << "] " << line << " (" << worker << ")\n" << std::flush;
+    if (!results_file.empty()) {
+        std::ofstream out(results_file, std::ios::app);
+        out << line << "\n";
+    }
+    if (analytics && result.outcome != "crashed") {
+        analytics->append(matches[index].id, matches[index].seed, result);
+    }
+}
+
+void TournamentCoordinator::print_standings() const {
+    struct Record {
+        int played = 0, wins = 0, draws = 0, losses = 0, crashed = 0;
+    };
+    std::map<std::string, Record> table;
+    for (size_t i = 0; i < matches.size(); i++) {
+        const MatchResult& result = results[i];
+        if (result.outcome == "unfinished") continue;
+        for (const auto& name : matches[i].robots) {
+            Record& record = table[name];
+            record.played++;
+            if (result.outcome == "crashed") record.crashed++;
+            else if (!result.winner.empty()) (result.winner == name ? record.wins : record.losses)++;
+            else if (result.outcome == "no_survivors") record.losses++;
+            else record.draws++;
+        }
+    }
+
+    std::vector<std::pair<std::string, Record>> order(table.begin(), table.end());
+    std::stable_sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+        if (a.second.wins != b.second.wins) return a.second.wins > b.second.wins;
+        return a.second.draws > b.second.draws;
+    });
+
+    std::cout << "\n=========== Standings ===========\n";
+    std::cout << std::left << std::setw(16) << "Robot" << std::right << std::setw(8) << "Played" << std::setw(6) << "Wins"
+              << std::setw(7) << "Draws" << std::setw(8) << "Losses" << std::setw(9) << "Crashed" << "\n";
+    for (const auto& [name, record] : order) {
+        std::cout << std::left << std::setw(16) << name << std::right << std::setw(8) << record.played
+                  << std::setw(6) << record.wins << std::setw(7) << record.draws << std::setw(8) << record.losses
+                  << std::setw(9) << record.crashed << "\n";
+    }
+}
+
+int TournamentCoordinator::run() {
+    build_matches();
+    if (matches.empty()) {
+        std::cerr << "No robots to play the tournament\n";
+        return 1;
+    }
+
+    int port;
+    listener = open_listener(port);
+    if (listener < 0) return 1;
+
+    int workers = local_workers >= 0 ? local_workers
+                                     : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    spawns_left = workers + static_cast<int>(matches.size()) * max_attempts;
+    std::cout << "Tournament of " << matches.size() << " matches, " << workers << " local workers, listening on port "
+              << port << "\n";
+    if (fork_server && workers > 0) {
+        int loaded = RobotLibraries::pin(roster);
+        std::cout << "Fork server: " << loaded << " robot libraries loaded once for all workers\n";
+    }
+    for (int i = 0; i < workers; i++) {
+        spawn_worker(port);
+    }
+
+    while (finished < static_cast<int>(matches.size())) {
+        reap_workers(port);
+        dispatch();
+        if (workers > 0 && local_pids.empty() && connections.empty() && spawns_left <= 0) {
+            std::cerr << "Every local worker has died; giving up\n";
+            break;
+        }
+
+        std::vector<pollfd> fds;
+        fds.push_back({listener, POLLIN, 0});
+        for (const auto& worker : connections) {
+            fds.push_back({worker.fd, POLLIN, 0});
+        }
+        int ready = poll(fds.data(), fds.size(), 1000);
+        if (ready < 0 && errno != EINTR) {
+            std::cerr << "poll failed: " << strerror(errno) << "\n";
+            break;
+        }
+
+        for (size_t i = 1; ready > 0 && i < fds.size(); i++) {
+            if (!fds[i].revents) continue;
+            Connection& worker = connections[i - 1];
+            std::deque<std::string> lines;
+            if (!receive_lines(worker.fd, worker.pending, lines)) {
+                lose(worker, "disconnected");
+                continue;
+            }
+            for (const auto& line : lines) {
+                if (!handle_line(worker, line)) {
+                    lose(worker, "sent an unexpected message");
+                    break;
+                }
+            }
+        }
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            int fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                Connection worker;
+                worker.fd = fd;
+                connections.push_back(worker);
+            }
+        }
+
+        // A worker stuck in a match is as good as dead
+        auto now = std::chrono::steady_clock::now();
+        for (auto& worker : connections) {
+            if (worker.fd >= 0 && worker.playing >= 0 && now > worker.deadline) {
+                if (worker.pid > 0) kill(worker.pid, SIGKILL);
+                lose(worker, "timed out");
+            }
+        }
+        connections.erase(std::remove_if(connections.begin(), connections.end(),
+                                         [](const Connection& worker) { return worker.fd < 0; }),
+                          connections.end());
+    }
+
+    for (auto& worker : connections) {
+        send_all(worker.fd, "done\n");
+        close(worker.fd);
+    }
+    close(listener);
+    for (pid_t pid : local_pids) {
+        waitpid(pid, nullptr, 0);
+    }
+
+    if (analytics) analytics->flush();
+    print_standings();
+    return finished == static_cast<int>(matches.size()) ? 0 : 1;
+}
+
+// ---------------------------------------------------------------- worker
+
+int TournamentWorker::run() {
+    return forks > 0 ? serve() : play();
+}
+
+// Load the robots, then keep `forks` workers running. A worker that a signal
+// killed (a robot crashed it, or the coordinator's timeout) is replaced; one
+// that exited on its own found the tournament over or the coordinator gone.
+int TournamentWorker::serve() {
+    int loaded = RobotLibraries::pin({});
+    std::cerr << "Fork server " << getpid() << ": " << loaded << " robot libraries loaded, starting " << forks
+              << " workers\n";
+
+    std::set<pid_t> children;
+    auto start = [&] {
+        pid_t pid = fork();
+        if (pid == 0) _exit(play());
+        if (pid < 0) std::cerr << "Could not start a worker: " << strerror(errno) << "\n";
+        else children.insert(pid);
+    };
+    for (int i = 0; i < forks; i++) {
+        start();
+    }
+
+    while (!children.empty()) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (!children.erase(pid) || !WIFSIGNALED(status)) continue;
+        std::cerr << "Worker " << pid << " killed by signal " << WTERMSIG(status) << ", starting another\n";
+        start();
+    }
+    return 0;
+}
+
+int TournamentWorker::play() {
+    std::string host, service;
+    if (!split_address(address, host, service)) return 1;
+
+    // The coordinator may still be starting; keep trying for a few seconds
+    int fd = -1;
+    for (int attempt = 0; attempt < 10 && fd < 0; attempt++) {
+        if (attempt > 0) sleep(1);
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* found = nullptr;
+        if (getaddrinfo(host.c_str(), service.c_str(), &hints, &found) != 0) continue;
+        for (addrinfo* ai = found; ai && fd < 0; ai = ai->ai_next) {
+            fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+            if (fd >= 0 && connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+                close(fd);
+                fd = -1;
+            }
+        }
+        freeaddrinfo(found);
+    }
+    if (fd < 0) {
+        std::cerr << "Could not reach coordinator at " << address << "\n";
+        return 1;
+    }
+
+    if (!send_all(fd, "hello " + host_name() + " " + std::to_string(getpid()) + "\n")) {
+        close(fd);
+        return 1;
+    }
+
+    std::string pending;
+    std::deque<std::string> lines;
+    auto next_line = [&](std::string& line) {
+        while (lines.empty()) {
+            if (!receive_lines(fd, pending, lines)) return false;
+        }
+        line = lines.front();
+        lines.pop_front();
+        return true;
+    };
+
+    std::string line;
+    while (next_line(line) && line != "done") {
+        std::istringstream fields(line);
+        std::string tag;
+        int id;
+        if (!(fields >> tag >> id) || tag != "match") {
+            std::cerr << "Unexpected message from coordinator: " << line << "\n";
+            break;
+        }
+
+        std::stringstream config;
+        bool complete = false;
+        while (next_line(line)) {
+            if (line == "end") {
+                complete = true;
+                break;
+            }
+            config << line << "\n";
+        }
+        if (!complete) break;
+
+        MatchResult result = play_match(config);
+        std::ostringstream reply;
+        reply << "result " << id << "\n";
+        result.write_lines(reply);
+        reply << "end\n";
+        if (!send_all(fd, reply.str())) break;
+    }
+
+    close(fd);
+    return 0;
+}
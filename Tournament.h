@@ -0,0 +1,109 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include "MatchResult.h"
+#include "AnalyticsStore.h"
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+// A tournament spread over processes, and from there over machines. The
+// coordinator owns the list of matches and hands them out over TCP, one at a
+// time, to worker processes; a worker plays each match with an ordinary Arena
+// and streams the result back. A worker that crashes (a robot segfaults, say)
+// or goes silent costs only time: its match goes back on the queue for
+// another worker, and after max_attempts tries it is scored as "crashed".
+//
+// Local workers normally start as fresh RobotWarz processes, and every match
+// compile-checks, dlopens and relocates its robot libraries anew. With
+// fork_server the coordinator loads the libraries once and forks its workers
+// instead, so each inherits them already mapped (copy-on-write) and a match
+// only creates the robots. `--worker host:port --forks N` does the same on
+// another machine: one process loads the robots and keeps N forked workers
+// running, replacing any that a crash kills.
+//
+// Wire protocol, one text line per item:
+//   worker -> coordinator   hello <host> <pid>
+//   coordinator -> worker   match <id>, the match's arena.config lines, end
+//   worker -> coordinator   result <id>, MatchResult::write_lines, end
+//   coordinator -> worker   done      (nothing left to play; the worker exits)
+
+// One match of the tournament: who plays, and with which seed.
+struct MatchSpec {
+    int id = 0;
+    std::vector<std::string> robots;
+    unsigned seed = 0;
+    int attempts = 0;                    // workers lost while playing it
+};
+
+class TournamentCoordinator {
+public:
+    bool load(const std::string& tournament_file);
+    int run();                           // process exit status
+
+private:
+    std::string listen_address = "127.0.0.1:5050";
+    int local_workers = -1;              // -1 = one per core
+    bool fork_server = false;            // fork local workers from a preloaded coordinator
+    int group_size = 2;                  // robots per match
+    int matches_per_group = 1;           // seeds first_seed, first_seed + 1, ...
+    unsigned first_seed = 1;
+    int max_attempts = 3;
+    int match_timeout = 600;             // seconds one match may take
+    std::string arena_config = "arena.config";
+    std::string results_file;            // one line per finished match, empty = off
+    std::unique_ptr<AnalyticsWriter> analytics;  // per-robot match stats, from analytics_file
+    std::vector<std::string> roster;     // empty = every Robot_*.cpp here
+    std::string base_config;             // arena_config minus the keys a match sets
+
+    std::vector<MatchSpec> matches;
+    std::vector<MatchResult> results;    // parallel to matches
+    std::deque<int> queue;               // matches waiting for a worker
+    int finished = 0;
+
+    // A worker connection. `playing` is the match it is busy with, or -1.
+    struct Connection {
+        int fd = -1;
+        std::string name;                // "host:pid" from hello, empty until then
+        pid_t pid = -1;                  // set for workers this process started
+        std::string pending;             // bytes after the last full line
+        int playing = -1;
+        std::chrono::steady_clock::time_point deadline;
+        bool in_result = false;          // between "result" and "end"
+        MatchResult result;
+    };
+    std::vector<Connection> connections;
+    int listener = -1;
+    std::set<pid_t> local_pids;
+    int spawns_left = 0;
+
+    void find_roster();
+    void build_matches();
+    int open_listener(int& port);
+    void spawn_worker(int port);
+    void reap_workers(int port);
+    bool handle_line(Connection& worker, const std::string& line);
+    void dispatch();
+    void lose(Connection& worker, const std::string& reason);
+    void record(int index, const MatchResult& result, const std::string& worker);
+    void print_standings() const;
+};
+
+class TournamentWorker {
+public:
+    explicit TournamentWorker(const std::string& address, int forks = 0) : address(address), forks(forks) {}
+    int run();                           // process exit status
+
+private:
+    std::string address;                 // coordinator "host:port"
+    int forks;                           // > 0: preload and keep this many forked workers
+
+    int play();                          // one worker: matches until the coordinator is done
+    int serve();                         // the fork server
+};
+
+#endif // TOURNAMENT_H
@@ -0,0 +1,112 @@
+#include "TraceRecorder.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+bool TraceRecorder::recording = false;
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    char detail[32];
+    std::chrono::steady_clock::time_point begin;
+    std::chrono::steady_clock::time_point end;
+};
+
+struct ThreadBuffer {
+    int tid;
+    std::vector<TraceEvent> events;
+};
+
+std::string trace_path;
+std::chrono::steady_clock::time_point trace_start;
+
+// Buffers outlive their threads so a worker's events survive until flush.
+std::mutex buffers_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+ThreadBuffer& this_thread_buffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = buffers.back().get();
+        buffer->tid = static_cast<int>(buffers.size());
+        buffer->events.reserve(4096);
+    }
+    return *buffer;
+}
+
+double micros(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+void write_json_string(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* p = text; *p; p++) {
+        if (*p == '"' || *p == '\\') out << '\\';
+        if (static_cast<unsigned char>(*p) >= 0x20) out << *p;
+    }
+    out << '"';
+}
+
+} // namespace
+
+void TraceRecorder::start(const std::string& path) {
+    trace_path = path;
+    trace_start = std::chrono::steady_clock::now();
+    recording = true;
+}
+
+void TraceRecorder::record(const char* name, const char* detail,
+                           std::chrono::steady_clock::time_point begin,
+                           std::chrono::steady_clock::time_point end) {
+    TraceEvent event;
+    event.name = name;
+    std::strncpy(event.detail, detail, sizeof(event.detail));
+    event.begin = begin;
+    event.end = end;
+    this_thread_buffer().events.push_back(event);
+}
+
+bool TraceRecorder::flush() {
+    if (!recording) return true;
+    recording = false;
+
+    std::ofstream file(trace_path);
+    if (!file.is_open()) {
+        std::cerr << "Could not write trace file " << trace_path << "\n";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& buffer : buffers) {
+        file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+             << ",\"args\":{\"name\":\"" << (buffer->tid == 1 ? "arena" : "worker") << "\"}}";
+        first = false;
+        for (const auto& event : buffer->events) {
+            file << ",\n{\"name\":";
+            write_json_string(file, event.name);
+            file << ",\"cat\":\"engine\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                 << ",\"ts\":" << micros(event.begin - trace_start)
+                 << ",\"dur\":" << micros(event.end - event.begin);
+            if (event.detail[0]) {
+                file << ",\"args\":{\"robot\":";
+                write_json_string(file, event.detail);
+                file << "}";
+            }
+            file << "}";
+        }
+        buffer->events.clear();
+    }
+    file << "\n]}\n";
+    return true;
+}
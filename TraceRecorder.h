@@ -0,0 +1,56 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+// Chrome/Perfetto trace-event recording. Each thread appends complete ("X")
+// events to its own buffer; nothing is written until flush(), so tracing a
+// match costs a clock read and a push_back per span.
+class TraceRecorder {
+public:
+    // Start recording; flush() writes the trace to `path`.
+    static void start(const std::string& path);
+    static bool enabled() { return recording; }
+
+    // Write every thread's events as trace-event JSON and stop recording.
+    static bool flush();
+
+    static void record(const char* name, const char* detail,
+                       std::chrono::steady_clock::time_point begin,
+                       std::chrono::steady_clock::time_point end);
+
+private:
+    static bool recording;
+};
+
+// One span on the timeline: from construction to destruction of the object.
+// `detail` (a robot name, say) is copied, so it may be a temporary.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, const std::string& detail = std::string())
+        : name(TraceRecorder::enabled() ? name : nullptr) {
+        if (this->name) {
+            size_t length = std::min(detail.size(), sizeof(this->detail) - 1);
+            std::memcpy(this->detail, detail.data(), length);
+            this->detail[length] = '\0';
+            begin = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~TraceSpan() {
+        if (name) TraceRecorder::record(name, detail, begin, std::chrono::steady_clock::now());
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name;
+    char detail[32];
+    std::chrono::steady_clock::time_point begin;
+};
+
+#endif // TRACE_RECORDER_H
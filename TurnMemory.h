@@ -0,0 +1,67 @@
+#ifndef TURN_MEMORY_H
+#define TURN_MEMORY_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+// Monotonic scratch memory for one robot turn. Everything the engine needs only
+// while a turn is being resolved is carved out of one buffer, and reset() at the
+// start of the next turn throws it all away at once - no malloc/free per turn.
+//
+// If a turn ever needs more than the buffer holds, the extra comes from the heap
+// for that turn and the buffer is grown at the next reset, so a steady-state
+// match stops touching the heap after its first busy turn.
+class TurnMemory {
+public:
+    explicit TurnMemory(size_t bytes = 64 * 1024) { allocate_buffer(bytes); }
+
+    TurnMemory(const TurnMemory&) = delete;
+    TurnMemory& operator=(const TurnMemory&) = delete;
+
+    std::pmr::memory_resource* resource() { return &*pool; }
+
+    void reset() {
+        if (overflow.bytes > 0) {
+            size_t wanted = size + overflow.bytes;
+            pool.reset();
+            allocate_buffer(wanted + wanted / 2);
+        } else {
+            pool->release();
+        }
+        overflow.bytes = 0;
+    }
+
+    size_t capacity() const { return size; }
+
+private:
+    // Heap fallback that remembers how much a turn spilled over.
+    struct Overflow : std::pmr::memory_resource {
+        size_t bytes = 0;
+
+        void* do_allocate(size_t n, size_t align) override {
+            bytes += n;
+            return std::pmr::new_delete_resource()->allocate(n, align);
+        }
+        void do_deallocate(void* p, size_t n, size_t align) override {
+            std::pmr::new_delete_resource()->deallocate(p, n, align);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    std::unique_ptr<std::byte[]> buffer;
+    size_t size = 0;
+    Overflow overflow;
+    std::optional<std::pmr::monotonic_buffer_resource> pool;
+
+    void allocate_buffer(size_t bytes) {
+        buffer = std::make_unique<std::byte[]>(bytes);
+        size = bytes;
+        pool.emplace(buffer.get(), size, &overflow);
+    }
+};
+
+#endif // TURN_MEMORY_H
@@ -0,0 +1,178 @@
+#include "TurnPartition.h"
+#include <algorithm>
+
+namespace {
+
+struct Box {
+    int top, bottom, left, right;
+};
+
+bool meet(int a0, int a1, int b0, int b1) {
+    return a0 <= b1 && b0 <= a1;
+}
+
+// Does the box reach into the zone of the robot at (row, col) moving in `own`?
+bool in_zone(const Box& box, const Box& own, int row, int col) {
+    return (meet(box.top, box.bottom, own.top, own.bottom) && meet(box.left, box.right, own.left, own.right))
+        || meet(box.top, box.bottom, row - 1, row + 1)
+        || meet(box.left, box.right, col - 1, col + 1)
+        || meet(box.top - box.right, box.bottom - box.left, row - col - 1, row - col + 1)
+        || meet(box.top + box.left, box.bottom + box.right, row + col - 1, row + col + 1);
+}
+
+template <typename Visit>
+void visit_lines(const std::vector<std::vector<size_t>>& lines, int first, int last, Visit&& visit) {
+    first = std::max(first, 0);
+    last = std::min(last, static_cast<int>(lines.size()) - 1);
+    for (int line = first; line <= last; line++) {
+        for (size_t index : lines[line]) visit(index);
+    }
+}
+
+} // namespace
+
+void TurnPartition::Lines::reset(int height, int width) {
+    for (auto* lines : {&row, &col, &diag, &anti}) {
+        for (auto& line : *lines) line.clear();
+    }
+    row.resize(height);
+    col.resize(width);
+    diag.resize(height + width - 1);
+    anti.resize(height + width - 1);
+}
+
+void TurnPartition::plan(int height, int width, const std::vector<Zone>& zones) {
+    size_t count = zones.size();
+    turns.assign(count, Turn());
+    boxes_on.reset(height, width);
+    robots_on.reset(height, width);
+    earlier.clear();
+    earlier_end.assign(count, 0);
+    seen.assign(count, count);
+    std::vector<Box> boxes(count);
+    std::vector<size_t> anywhere;
+
+    // Each robot against the ones before it, so every pair is looked at once
+    for (size_t j = 0; j < count; j++) {
+        const Zone& zone = zones[j];
+        size_t found = earlier.size();
+        if (zone.active) {
+            int reach = std::max(zone.speed, 0);
+            const Box& box = boxes[j] = {std::max(zone.row - reach, 0), std::min(zone.row + reach, height - 1),
+                                         std::max(zone.col - reach, 0), std::min(zone.col + reach, width - 1)};
+            auto check = [&](size_t i) {
+                if (seen[i] == j) return;
+                seen[i] = j;
+                if (zone.anywhere || zones[i].anywhere || in_zone(boxes[i], box, zone.row, zone.col)
+                    || in_zone(box, boxes[i], zones[i].row, zones[i].col)) {
+                    earlier.push_back(i);
+                }
+            };
+            if (zone.anywhere) {
+                for (size_t i = 0; i < j; i++) {
+                    if (zones[i].active) check(i);
+                }
+            } else {
+                for (size_t i : anywhere) check(i);
+                // Boxes reaching into this robot's zone...
+                int d = zone.row - zone.col + width - 1, a = zone.row + zone.col;
+                visit_lines(boxes_on.row, std::min(box.top, zone.row - 1), std::max(box.bottom, zone.row + 1), check);
+                visit_lines(boxes_on.col, zone.col - 1, zone.col + 1, check);
+                visit_lines(boxes_on.diag, d - 1, d + 1, check);
+                visit_lines(boxes_on.anti, a - 1, a + 1, check);
+                // ...and robots whose zones reach into its box
+                visit_lines(robots_on.row, box.top - 1, box.bottom + 1, check);
+                visit_lines(robots_on.col, box.left - 1, box.right + 1, check);
+                visit_lines(robots_on.diag, box.top - box.right + width - 2, box.bottom - box.left + width, check);
+                visit_lines(robots_on.anti, box.top + box.left - 1, box.bottom + box.right + 1, check);
+            }
+            std::sort(earlier.begin() + found, earlier.end());
+
+            turns[j].active = true;
+            turns[j].waiting = static_cast<int>(earlier.size() - found);
+            if (zone.anywhere) anywhere.push_back(j);
+            for (int r = box.top; r <= box.bottom; r++) boxes_on.row[r].push_back(j);
+            for (int c = box.left; c <= box.right; c++) boxes_on.col[c].push_back(j);
+            for (int d = box.top - box.right; d <= box.bottom - box.left; d++) boxes_on.diag[d + width - 1].push_back(j);
+            for (int a = box.top + box.left; a <= box.bottom + box.right; a++) boxes_on.anti[a].push_back(j);
+            robots_on.row[zone.row].push_back(j);
+            robots_on.col[zone.col].push_back(j);
+            robots_on.diag[zone.row - zone.col + width - 1].push_back(j);
+            robots_on.anti[zone.row + zone.col].push_back(j);
+        }
+        earlier_end[j] = earlier.size();
+    }
+
+    // Lay out each robot's overlapping list: the earlier ones, then the later
+    // ones - which come in turn order as the earlier lists are walked in order
+    std::vector<size_t> later_count(count, 0);
+    for (size_t i : earlier) later_count[i]++;
+    size_t next = 0;
+    for (size_t j = 0; j < count; j++) {
+        size_t earlier_count = earlier_end[j] - (j ? earlier_end[j - 1] : 0);
+        turns[j].first = next;
+        turns[j].middle = next + earlier_count;
+        turns[j].last = turns[j].middle + later_count[j];
+        next = turns[j].last;
+    }
+    overlaps.resize(next);
+    std::vector<size_t> fill(count);
+    for (size_t j = 0; j < count; j++) {
+        size_t begin = j ? earlier_end[j - 1] : 0;
+        std::copy(earlier.begin() + begin, earlier.begin() + earlier_end[j], overlaps.begin() + turns[j].first);
+        fill[j] = turns[j].middle;
+    }
+    for (size_t j = 0; j < count; j++) {
+        for (size_t k = j ? earlier_end[j - 1] : 0; k < earlier_end[j]; k++) {
+            overlaps[fill[earlier[k]]++] = j;
+        }
+    }
+}
+
+void TurnPartition::start(int lane_count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    lanes = std::max(lane_count, 1);
+    busy = 0;
+    ready = {};
+    for (size_t i = 0; i < turns.size(); i++) {
+        turns[i].finished = !turns[i].active;
+        if (turns[i].active && turns[i].waiting == 0) ready.push(i);
+    }
+    finished_before = 0;
+    while (finished_before < turns.size() && turns[finished_before].finished) finished_before++;
+}
+
+bool TurnPartition::take(size_t& index) {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        if (finished_before == turns.size()) return false;
+        // A later turn may wait for the earliest; never let them fill every lane
+        if (!ready.empty() && (ready.top() == finished_before || busy < lanes - 1)) {
+            index = ready.top();
+            ready.pop();
+            busy++;
+            return true;
+        }
+        progress.wait(lock);
+    }
+}
+
+void TurnPartition::finish(size_t index, const std::function<void(size_t)>& in_order) {
+    std::lock_guard<std::mutex> lock(mutex);
+    busy--;
+    turns[index].finished = true;
+    const Turn& turn = turns[index];
+    for (size_t k = turn.middle; k < turn.last; k++) {
+        if (--turns[overlaps[k]].waiting == 0) ready.push(overlaps[k]);
+    }
+    while (finished_before < turns.size() && turns[finished_before].finished) {
+        if (turns[finished_before].active) in_order(finished_before);
+        finished_before++;
+    }
+    progress.notify_all();
+}
+
+void TurnPartition::wait_for_earlier(size_t index) {
+    std::unique_lock<std::mutex> lock(mutex);
+    progress.wait(lock, [&] { return finished_before >= index; });
+}
@@ -0,0 +1,95 @@
+#ifndef TURN_PARTITION_H
+#define TURN_PARTITION_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <span>
+#include <vector>
+
+// Splits a round of turns, played in turn order, into turns that can be
+// resolved side by side with the same outcome.
+//
+// A robot's zone for the round is every cell its turn can look at or change:
+// the cells it can move to, and its radar and weapon reach from where it
+// starts. Radar beams and railgun shots run to the board edge along its row,
+// column and diagonals, so the zone is those four 3-wide lines plus the box
+// it can move in - or the whole board for a grenade, which lands anywhere.
+// Two turns whose zones meet only where neither robot can move don't see each
+// other; the rest keep their order. Boxes and positions are indexed by board
+// line, as the sparse radar indexes objects, so finding the overlaps costs
+// about the robots near each robot's lines rather than every pair.
+//
+// Scheduling: lanes (threads) take() turns whose earlier overlapping turns are
+// all finished, lowest first, and finish() them. A turn may also wait for
+// every turn before it (wait_for_earlier) - the arena's dice are drawn in
+// turn order - so one lane is always kept for the earliest unfinished turn,
+// which never waits.
+class TurnPartition {
+public:
+    // A robot at the start of the round
+    struct Zone {
+        bool active = false;      // has a turn this round
+        int row = 0;
+        int col = 0;
+        int speed = 0;            // how far it can move
+        bool anywhere = false;    // its shot can land on any cell
+    };
+
+    // Works out which turns overlap. zones are in turn order.
+    void plan(int height, int width, const std::vector<Zone>& zones);
+
+    // The active robots whose zones overlap robot `index`'s, in turn order
+    std::span<const size_t> overlapping(size_t index) const {
+        return {overlaps.data() + turns[index].first, turns[index].last - turns[index].first};
+    }
+
+    // Opens the round for `lanes` threads, each of which loops take/finish
+    void start(int lanes);
+
+    // The next turn for this lane; false once every turn is finished
+    bool take(size_t& index);
+
+    // Calls in_order(i) for each turn that is now finished along with every
+    // turn before it, in turn order and one call at a time
+    void finish(size_t index, const std::function<void(size_t)>& in_order);
+
+    // Blocks until every turn before `index` is finished
+    void wait_for_earlier(size_t index);
+
+private:
+    struct Turn {
+        bool active = false;
+        bool finished = false;
+        int waiting = 0;              // earlier overlapping turns not finished yet
+        // Its overlapping robots are overlaps[first, last): the earlier ones up to middle
+        size_t first = 0;
+        size_t middle = 0;
+        size_t last = 0;
+    };
+    std::vector<Turn> turns;
+    std::vector<size_t> overlaps;
+
+    // The robots planned so far: their boxes by the rows, columns, diagonals
+    // (row - col) and anti-diagonals (row + col) they cover, and their
+    // positions by line. Reused from round to round.
+    struct Lines {
+        std::vector<std::vector<size_t>> row, col, diag, anti;
+        void reset(int height, int width);
+    };
+    Lines boxes_on, robots_on;
+    std::vector<size_t> earlier;      // per robot, before overlaps is laid out
+    std::vector<size_t> earlier_end;
+    std::vector<size_t> seen;
+
+    std::mutex mutex;
+    std::condition_variable progress;
+    std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> ready;
+    size_t finished_before = 0;       // every turn before this one is finished
+    int lanes = 1;
+    int busy = 0;                     // lanes resolving a turn
+};
+
+#endif // TURN_PARTITION_H
@@ -0,0 +1,110 @@
+#ifndef WEAPON_PATTERNS_H
+#define WEAPON_PATTERNS_H
+
+#include "RobotBase.h"
+#include <array>
+
+// Weapon footprints as offset tables built at compile time. handle_shot picks
+// the table for the shooter's weapon and direction and walks it - no branching
+// per cell and no allocation per shot.
+
+struct CellOffset {
+    int dr;
+    int dc;
+};
+
+// Direction index (1-8, see `directions`) of the unit step from one cell toward
+// another. 0 when both cells are the same.
+constexpr int direction_toward(int from_row, int from_col, int to_row, int to_col) {
+    int dr = (to_row > from_row) ? 1 : (to_row < from_row) ? -1 : 0;
+    int dc = (to_col > from_col) ? 1 : (to_col < from_col) ? -1 : 0;
+    for (int d = 1; d <= 8; d++) {
+        if (directions[d].first == dr && directions[d].second == dc) return d;
+    }
+    return 0;
+}
+
+// One cell of a 3-wide beam `dist` cells out in `direction`. lane -1 and +1 are
+// the side cells: beside the centre cell for straight beams, and one step further
+// along the row (lane -1) or column (lane +1) for diagonal beams.
+constexpr CellOffset beam_offset(int direction, int dist, int lane) {
+    int dr = directions[direction].first;
+    int dc = directions[direction].second;
+    CellOffset cell{dr * dist, dc * dist};
+    if (dr == 0) cell.dr += lane;
+    else if (dc == 0) cell.dc += lane;
+    else if (lane == -1) cell.dr += dr;
+    else if (lane == 1) cell.dc += dc;
+    return cell;
+}
+
+constexpr int flamethrower_range = 4;
+constexpr int flamethrower_cells = flamethrower_range * 3;
+
+constexpr std::array<std::array<CellOffset, flamethrower_cells>, 9> make_flamethrower_cones() {
+    std::array<std::array<CellOffset, flamethrower_cells>, 9> cones{};
+    for (int direction = 1; direction <= 8; direction++) {
+        int i = 0;
+        for (int dist = 1; dist <= flamethrower_range; dist++) {
+            for (int lane = -1; lane <= 1; lane++) {
+                cones[direction][i++] = beam_offset(direction, dist, lane);
+            }
+        }
+    }
+    return cones;
+}
+
+constexpr std::array<CellOffset, 9> make_grenade_splash() {
+    std::array<CellOffset, 9> splash{};
+    int i = 0;
+    for (int dr = -1; dr <= 1; dr++) {
+        for (int dc = -1; dc <= 1; dc++) {
+            splash[i++] = {dr, dc};
+        }
+    }
+    return splash;
+}
+
+constexpr auto flamethrower_cones = make_flamethrower_cones();
+constexpr auto grenade_splash = make_grenade_splash();
+constexpr std::array<CellOffset, 1> hammer_strike = {{{0, 0}}};
+
+// Per-weapon traits. `fixed` weapons apply offsets() relative to `at_target`
+// (the aimed cell) or the shooter; the railgun is a ray to the board edge.
+template <WeaponType W> struct WeaponPattern;
+
+template <> struct WeaponPattern<railgun> {
+    static constexpr const char* name = "railgun";
+    static constexpr bool fixed = false;
+};
+
+template <> struct WeaponPattern<flamethrower> {
+    static constexpr const char* name = "flamethrower";
+    static constexpr bool fixed = true;
+    static constexpr bool at_target = false;
+    static constexpr bool in_reach(int, int, int, int) { return true; }
+    static constexpr const auto& offsets(int direction) { return flamethrower_cones[direction]; }
+};
+
+template <> struct WeaponPattern<grenade> {
+    static constexpr const char* name = "grenade";
+    static constexpr bool fixed = true;
+    static constexpr bool at_target = true;
+    static constexpr bool in_reach(int, int, int, int) { return true; }
+    static constexpr const auto& offsets(int) { return grenade_splash; }
+};
+
+template <> struct WeaponPattern<hammer> {
+    static constexpr const char* name = "hammer";
+    static constexpr bool fixed = true;
+    static constexpr bool at_target = true;
+    // the hammer only lands on an adjacent cell
+    static constexpr bool in_reach(int shooter_row, int shooter_col, int shot_row, int shot_col) {
+        int dr = shot_row - shooter_row;
+        int dc = shot_col - shooter_col;
+        return dr >= -1 && dr <= 1 && dc >= -1 && dc <= 1;
+    }
+    static constexpr const auto& offsets(int) { return hammer_strike; }
+};
+
+#endif // WEAPON_PATTERNS_H
@@ -0,0 +1,33 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(int threads) {
+    if (threads < 1) threads = 1;
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back(&WorkerPool::work, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkerPool::work() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) return;  // stopping and drained
+            job = std::move(jobs.front());
+            jobs.pop();
+        }
+        job();
+    }
+}
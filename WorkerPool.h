@@ -0,0 +1,49 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads running submitted jobs in FIFO order.
+class WorkerPool {
+public:
+    explicit WorkerPool(int threads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int size() const { return static_cast<int>(workers.size()); }
+
+    // Queue a job; the future yields its result (or rethrows its exception).
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& job) {
+        using R = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(job));
+        std::future<R> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push([task] { (*task)(); });
+        }
+        wake.notify_one();
+        return result;
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void work();
+};
+
+#endif // WORKER_POOL_H
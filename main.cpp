@@ -1,15 +1,134 @@
 #include "Arena.h"
+#include "TraceRecorder.h"
+#include "Tournament.h"
+#include "MapFile.h"
+#include "BatchEnv.h"
+#include "AnalyticsStore.h"
+#include "Spectator.h"
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
 
-int main() {
-    Arena arena;
+// One match in arena.config, recorded or replayed
+template <typename ArenaType>
+int play_match(ArenaType& arena, const std::string& record_file, const std::string& replay_file) {
+    if (!replay_file.empty()) {
+        if (!arena.initialize_replay("arena.config", replay_file)) return 1;
+    } else {
+        if (!arena.initialize("arena.config")) return 1;
+        if (!record_file.empty()) arena.record_decisions(record_file);
+    }
+    arena.run();
+    TraceRecorder::flush();
+    
+    return arena.replay_matched() ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    std::string tournament_file;
+    std::string coordinator_address;
+    std::string record_file;
+    std::string replay_file;
+    std::vector<std::string> observer_plugins;
+    int forks = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--trace" && i + 1 < argc) {
+            TraceRecorder::start(argv[++i]);
+        } else if (arg == "--tournament" && i + 1 < argc) {
+            tournament_file = argv[++i];
+        } else if (arg == "--worker" && i + 1 < argc) {
+            coordinator_address = argv[++i];
+        } else if (arg == "--forks" && i + 1 < argc) {
+            forks = std::stoi(argv[++i]);
+        } else if (arg == "--record" && i + 1 < argc) {
+            record_file = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replay_file = argv[++i];
+        } else if (arg == "--observer" && i + 1 < argc) {
+            observer_plugins.push_back(argv[++i]);
+        } else if (arg == "--convert-map" && i + 2 < argc) {
+            // Text map in, binary map out
+            ArenaGrid grid;
+            std::vector<SpawnPoint> spawns;
+            bool converted = load_map(argv[i + 1], grid, spawns) && save_binary_map(argv[i + 2], grid, spawns);
+            return converted ? 0 : 1;
+        } else if (arg == "--watch" && i + 1 < argc) {
+            return watch_match(argv[i + 1]);
+        } else if (arg == "--query" && i + 1 < argc) {
+            // Statistic names follow the file
+            std::vector<std::string> columns(argv + i + 2, argv + argc);
+            return query_analytics(argv[i + 1], columns);
+        } else if (arg == "--batch-bench" && i + 2 < argc) {
+            // Learners taking random actions in batched arenas: how fast the engine steps
+            int batch = std::stoi(argv[i + 1]), steps = std::stoi(argv[i + 2]);
+            std::ifstream file("arena.config");
+            std::stringstream config;
+            config << file.rdbuf();
+            BatchEnv env(batch, config.str());
+            if (!env.reset(1)) return 1;
+            std::mt19937 rng(1);
+            std::vector<int32_t> actions(batch * env.learners() * BatchEnv::action_size);
+            long episodes = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int s = 0; s < steps; s++) {
+                for (size_t a = 0; a < actions.size(); a += BatchEnv::action_size) {
+                    actions[a] = 1 + rng() % 8;
+                    actions[a + 1] = rng() % 3;
+                    actions[a + 2] = rng() % 20;
+                    actions[a + 3] = rng() % 20;
+                }
+                env.step(actions.data());
+                for (int e = 0; e < batch; e++) episodes += env.dones()[e];
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << long(batch) * steps << " env steps (" << episodes << " episodes) in " << seconds << "s: "
+                      << long(batch) * steps / seconds << " steps/s\n";
+            return 0;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--trace trace.json] [--record match.rwlog | --replay match.rwlog]\n"
+                      << "       " << argv[0] << " [...] --observer plugin.so [--observer plugin.so ...]\n"
+                      << "       " << argv[0] << " --tournament tournament.config\n"
+                      << "       " << argv[0] << " --worker host:port [--forks N]\n"
+                      << "       " << argv[0] << " --convert-map map.txt map.rwmap\n"
+                      << "       " << argv[0] << " --watch socket\n"
+                      << "       " << argv[0] << " --query stats.rwstat [statistic ...]\n"
+                      << "       " << argv[0] << " --batch-bench envs steps\n";
+            return 1;
+        }
+    }
+    
+    if (!coordinator_address.empty()) {
+        return TournamentWorker(coordinator_address, forks).run();
+    }
     
     std::cout << "===========================================\n";
     std::cout << "         R O B O T W A R Z\n";
     std::cout << "===========================================\n";
     
-    arena.initialize("arena.config");
-    arena.run();
+    if (!tournament_file.empty()) {
+        TournamentCoordinator coordinator;
+        if (!coordinator.load(tournament_file)) return 1;
+        return coordinator.run();
+    }
     
-    return 0;
+    if (!observer_plugins.empty()) {
+        // Engine events go to the plugins; the plain Arena doesn't have them
+        std::vector<std::unique_ptr<MatchObserver>> observers;
+        ObservedArena arena;
+        for (const auto& plugin : observer_plugins) {
+            observers.emplace_back(load_observer_plugin(plugin));
+            if (!observers.back()) return 1;
+            arena.observers().add(observers.back().get());
+        }
+        return play_match(arena, record_file, replay_file);
+    }
+    
+    Arena arena;
+    return play_match(arena, record_file, replay_file);
 }
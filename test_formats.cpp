@@ -0,0 +1,226 @@
+// Round-trip and damaged-file checks for the engine's binary file formats.
+// Run from the build directory: ./test_formats. Scratch files go to /tmp.
+// Exits non-zero if any check fails.
+#include "AnalyticsStore.h"
+#include "DecisionLog.h"
+#include "MapFile.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cout << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+std::string scratch(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("rw_test_" + std::to_string(getpid()) + "_" + name)).string();
+}
+
+// Cuts the file down to its first `size` bytes
+void truncate_to(const std::string& path, uintmax_t size) {
+    std::filesystem::resize_file(path, size);
+}
+
+// ---------------------------------------------------------------- decision log
+
+void test_decision_log() {
+    std::string path = scratch("match.rwlog");
+    DecisionLogHeader header;
+    header.seed = 123456789;
+    header.width = 40;
+    header.height = 25;
+    header.max_rounds = 500;
+    header.num_mounds = 7;
+    header.map_file = "maps/arena.rwmap";
+    header.terrain = true;
+    header.mound_density = 0.125;
+    header.terrain_smoothing = 3;
+    header.stalemate_tiebreak = "health";
+    header.simultaneous = true;
+    header.robots = {{"Blaster", 3, 2, railgun}, {"Ratboy", 5, 0, grenade}};
+
+    TurnPlan shot;
+    shot.shoot = true;
+    shot.shot_row = 24;
+    shot.shot_col = -1;
+    TurnPlan step;
+    step.move_direction = 7;
+    step.move_distance = 300;
+    {
+        DecisionLogWriter writer;
+        check(writer.open(path, header), "decision log: open for writing");
+        writer.turn(3, shot);
+        writer.turn(-2, step);               // radar direction outside 0-8 is escaped
+        writer.turn(0, TurnPlan());
+        writer.disqualified();
+        writer.end_round(0x0123456789ABCDEFull);
+    }
+    uintmax_t full_size = std::filesystem::file_size(path);
+
+    DecisionLogReader reader;
+    DecisionLogHeader read;
+    check(reader.open(path, read), "decision log: open for reading");
+    check(read.seed == header.seed && read.width == 40 && read.height == 25 && read.max_rounds == 500 &&
+          read.num_mounds == 7, "decision log: header numbers");
+    check(read.map_file == header.map_file && read.stalemate_tiebreak == "health", "decision log: header strings");
+    check(read.terrain && read.mound_density == 0.125 && read.terrain_smoothing == 3 && read.simultaneous,
+          "decision log: terrain settings");
+    check(read.robots.size() == 2 && read.robots[1].name == "Ratboy" && read.robots[1].move == 5 &&
+          read.robots[1].weapon == grenade, "decision log: roster");
+
+    int radar;
+    TurnPlan plan;
+    check(reader.next_turn(radar, plan) && radar == 3 && plan.shoot && plan.shot_row == 24 && plan.shot_col == -1,
+          "decision log: shot");
+    check(reader.next_turn(radar, plan) && radar == -2 && !plan.shoot && plan.move_direction == 7 &&
+          plan.move_distance == 300, "decision log: move with escaped radar direction");
+    check(reader.next_turn(radar, plan) && radar == 0 && !plan.shoot && plan.move_distance == 0,
+          "decision log: idle turn");
+    check(!reader.next_turn(radar, plan) && reader.next_disqualified(), "decision log: disqualification");
+    uint64_t checksum = 0;
+    check(!reader.next_turn(radar, plan) && reader.next_round_end(checksum) && checksum == 0x0123456789ABCDEFull,
+          "decision log: round end");
+    check(!reader.next_turn(radar, plan) && !reader.next_round_end(checksum), "decision log: end of file");
+
+    // A round end cut short reads as a divergence, not as a round
+    truncate_to(path, full_size - 3);
+    DecisionLogReader cut;
+    check(cut.open(path, read), "decision log: truncated records keep the header");
+    for (int i = 0; i < 3; i++) cut.next_turn(radar, plan);
+    cut.next_disqualified();
+    check(!cut.next_round_end(checksum), "decision log: truncated round end rejected");
+
+    // A header cut short is not a log
+    truncate_to(path, 20);
+    DecisionLogReader headless;
+    check(!headless.open(path, read), "decision log: truncated header rejected");
+    std::filesystem::remove(path);
+}
+
+// ---------------------------------------------------------------- map file
+
+void test_map_file() {
+    std::string path = scratch("board.rwmap");
+    ArenaGrid grid;
+    grid.reset(30, 50);
+    grid.set(0, 0, 'M');
+    grid.set(12, 31, 'P');
+    grid.set(29, 49, 'F');
+    std::vector<SpawnPoint> spawns = {{1, 1}, {28, 2}, {15, 40}};
+    check(save_binary_map(path, grid, spawns), "map: save");
+
+    ArenaGrid loaded;
+    std::vector<SpawnPoint> read;
+    check(load_map(path, loaded, read), "map: load");
+    bool same = loaded.height() == 30 && loaded.width() == 50;
+    for (int r = 0; same && r < 30; r++) {
+        for (int c = 0; c < 50; c++) same = same && loaded.at(r, c) == grid.at(r, c);
+    }
+    check(same, "map: cells");
+    check(read.size() == 3 && read[1].row == 28 && read[1].col == 2 && read[2].col == 40, "map: spawn points");
+    uintmax_t full_size = std::filesystem::file_size(path);
+
+    // A cell that is not a board character
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(full_size - 7));
+        file.put('X');
+    }
+    check(!load_map(path, loaded, read), "map: unknown cell rejected");
+
+    // Cells cut short, then the header itself
+    truncate_to(path, full_size - 1);
+    check(!load_map(path, loaded, read), "map: truncated cells rejected");
+    truncate_to(path, 12);
+    check(!load_map(path, loaded, read), "map: truncated header rejected");
+    std::filesystem::remove(path);
+}
+
+// ---------------------------------------------------------------- analytics store
+
+MatchResult analytics_match(int seed) {
+    MatchResult result;
+    result.outcome = "winner";
+    result.winner = "Ratboy";
+    result.rounds = 90 + seed;
+    for (const char* name : {"Blaster", "Ratboy"}) {
+        MatchResult::RobotResult robot;
+        robot.name = name;
+        robot.health = seed * 3;
+        robot.armor = 2;
+        robot.stats.shots[railgun] = seed;
+        robot.stats.damage_dealt = 1000 - seed;
+        robot.stats.distance_moved = -seed;        // negative deltas too
+        result.robots.push_back(robot);
+    }
+    return result;
+}
+
+void test_analytics_store() {
+    std::string path = scratch("stats.rwstat");
+    std::filesystem::remove(path);
+    {
+        AnalyticsWriter writer(path, 3);             // chunks of 3 rows: a match spans two
+        for (int seed = 1; seed <= 4; seed++) writer.append(seed, seed, analytics_match(seed));
+    }
+    uintmax_t full_size = std::filesystem::file_size(path);
+
+    std::vector<int> every;
+    for (int c = 0; c < analytics_column_count; c++) every.push_back(c);
+    AnalyticsReader reader;
+    check(reader.open(path), "analytics: open");
+    AnalyticsReader::Chunk chunk;
+    size_t rows = 0;
+    bool same = true;
+    while (reader.next(every, chunk)) {
+        for (size_t r = 0; r < chunk.rows; r++, rows++) {
+            int seed = static_cast<int>(rows / 2) + 1;
+            const std::string& name = chunk.names.at(chunk.columns[col_robot][r]);
+            same = same && chunk.columns[col_match][r] == seed && chunk.columns[col_rounds][r] == 90 + seed &&
+                   name == (rows % 2 ? "Ratboy" : "Blaster") &&
+                   chunk.columns[col_result][r] == (rows % 2 ? 1 : -1) &&
+                   chunk.columns[col_health][r] == seed * 3 && chunk.columns[col_shots_railgun][r] == seed &&
+                   chunk.columns[col_damage_dealt][r] == 1000 - seed &&
+                   chunk.columns[col_distance_moved][r] == -seed;
+        }
+    }
+    check(rows == 8 && same, "analytics: rows read back");
+
+    // The last chunk cut short: the chunks before it still read
+    truncate_to(path, full_size - 5);
+    AnalyticsReader cut;
+    rows = 0;
+    check(cut.open(path), "analytics: open truncated");
+    while (cut.next({col_match}, chunk)) rows += chunk.rows;
+    check(rows == 6, "analytics: truncated chunk dropped");
+
+    truncate_to(path, 5);
+    AnalyticsReader headless;
+    check(!headless.open(path), "analytics: truncated file header rejected");
+    std::filesystem::remove(path);
+}
+
+} // namespace
+
+int main() {
+    test_decision_log();
+    test_map_file();
+    test_analytics_store();
+
+    if (failures) {
+        std::cout << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All format checks passed\n";
+    return 0;
+}
@@ -1,16 +1,53 @@
 #include "RobotBase.h"
+#include "RobotPlanner.h"
+#include "WeaponPatterns.h"
+#include "RadarEngine.h"
 #include <iostream>
+#include <iomanip>
 #include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <new>
+#include <type_traits>
 #include <dlfcn.h>
 #include <algorithm>
 
-RobotBase* load_robot(const std::string& shared_lib, void* &handle) 
+// Allocation counting. These replace the global operator new/delete for the whole
+// process - including the robot's shared library - so we can count what the robot
+// allocates while one of its functions is running.
+static bool g_counting = false;
+static uint64_t g_allocations = 0;
+static uint64_t g_allocated_bytes = 0;
+
+static void* counted_alloc(std::size_t size)
+{
+    if (g_counting)
+    {
+        g_allocations++;
+        g_allocated_bytes += size;
+    }
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) { return counted_alloc(size); }
+void* operator new[](std::size_t size) { return counted_alloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+RobotFactory load_robot_factory(const std::string& shared_lib, void* &handle)
 {
     std::cout << "Testing robot from " << shared_lib << "...\n";
 
     // Dynamically load the shared library
     handle = dlopen(shared_lib.c_str(), RTLD_LAZY);
-    if (!handle) 
+    if (!handle)
     {
         std::cerr << "Failed to load " << shared_lib << ": " << dlerror() << '\n';
         return nullptr;
@@ -19,140 +56,347 @@ RobotBase* load_robot(const std::string& shared_lib, void* &handle)
     // Locate the create function to create the robot and 'assign' the function to this 'create_robot' function.
     // RobotFactory is a function pointer type 'typedef'ed in RobotBase.h
     RobotFactory create_robot = (RobotFactory)dlsym(handle, "create_robot");
-    if (!create_robot) 
+    if (!create_robot)
     {
         std::cerr << "Failed to find create_robot in " << shared_lib << ": " << dlerror() << '\n';
         dlclose(handle);
         return nullptr;
     }
 
-    // Instantiate the robot - it will need to be deleted later. This actually calls the function that exists
-    // in the ROBOT code! Cool huh! It's in the bottom of the Robot where it says extern "C"
-    RobotBase* robot = create_robot();
-    if (!robot) 
-    {
-        std::cerr << "Failed to create robot instance from " << shared_lib << '\n';
-        dlclose(handle);
-        return nullptr;
-    }
-
-    return robot;
+    return create_robot;
 }
 
-// you can add or remove behaviors here if you like.
-// make a custom version of this tester, so that it tests YOUR robot...
-void test_robot_behavior(RobotBase* robot) 
+// The robot functions the harness times, in the order the arena calls them.
+enum Call { call_radar, call_process, call_shot, call_move, call_count };
+const char* call_names[call_count] = {"get_radar_direction", "process_radar_results",
+                                      "get_shot_location", "get_move_direction"};
+
+// Latency histogram with power-of-two nanosecond buckets - cheap enough to
+// record every call of a multi-million turn run.
+struct CallStats
 {
-    // Set up the robot
-    robot->set_boundaries(20, 20);
-    robot->move_to(10, 10); // Start in the middle of the arena
+    uint64_t calls = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+    uint64_t allocations = 0;
+    uint64_t allocated_bytes = 0;
+    uint64_t buckets[64] = {};
+
+    void record(uint64_t ns, uint64_t allocs, uint64_t bytes)
+    {
+        calls++;
+        total_ns += ns;
+        max_ns = std::max(max_ns, ns);
+        allocations += allocs;
+        allocated_bytes += bytes;
+        int bucket = 0;
+        while (bucket < 63 && (uint64_t(1) << (bucket + 1)) <= ns)
+            bucket++;
+        buckets[bucket]++;
+    }
 
-    // Print robot stats
-    std::cout << "Robot Stats:" << std::endl;
-    robot->print_stats();
+    // upper bound of the bucket holding the given percentile
+    uint64_t percentile_ns(double pct) const
+    {
+        uint64_t wanted = static_cast<uint64_t>(calls * pct / 100.0);
+        uint64_t seen = 0;
+        for (int b = 0; b < 64; b++)
+        {
+            seen += buckets[b];
+            if (seen > wanted)
+                return uint64_t(1) << (b + 1);
+        }
+        return max_ns;
+    }
+};
 
-    int inactive_turns = 0;
+// Runs one robot call, timing it and counting its allocations.
+template <typename F>
+auto timed(CallStats& stats, F&& f)
+{
+    uint64_t allocs = g_allocations, bytes = g_allocated_bytes;
+    g_counting = true;
+    auto start = std::chrono::steady_clock::now();
+    if constexpr (std::is_void_v<decltype(f())>)
+    {
+        f();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        g_counting = false;
+        stats.record(ns, g_allocations - allocs, g_allocated_bytes - bytes);
+    }
+    else
+    {
+        auto result = f();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        g_counting = false;
+        stats.record(ns, g_allocations - allocs, g_allocated_bytes - bytes);
+        return result;
+    }
+}
 
-    for (int turn = 1; turn <= 10; ++turn) {
-        std::cout << "\nSimulating turn " << turn << ":\n";
+struct HarnessOptions
+{
+    uint64_t turns = 1000000;
+    uint64_t seed = 1;
+    int min_board = 10;
+    int max_board = 500;
+    double max_p99_us = 0;   // 0 means no latency gate
+};
+
+struct Violations
+{
+    uint64_t count = 0;
+    uint64_t over_speed = 0;  // legal (the arena caps it) but worth knowing about
 
-        bool took_action = false;
+    void report(uint64_t turn, int rows, int cols, const std::string& what)
+    {
+        if (count++ < 10)
+        {
+            std::cerr << "Violation on turn " << turn << " (board " << rows << "x" << cols << "): "
+                      << what << '\n';
+        }
+    }
+};
 
-        // Simulate radar results
-        std::vector<RadarObj> radar_results;
-        int radar_direction = 0;
+// Fills radar_results with random objects that could really be in the scanned area.
+void random_radar(std::mt19937_64& rng, int rows, int cols, int row, int col, int direction,
+                  std::vector<RadarObj>& radar_results)
+{
+    static const char types[] = {'R', 'X', 'M', 'P', 'F'};
+    radar_results.clear();
+    int objects = rng() % 6;
+    int reach = std::max(rows, cols);
+    for (int i = 0; i < objects; i++)
+    {
+        CellOffset offset;
+        if (direction == 0)
+        {
+            offset = {int(rng() % 3) - 1, int(rng() % 3) - 1};
+        }
+        else
+        {
+            offset = beam_offset(direction, 1 + rng() % (reach - 1), int(rng() % 3) - 1);
+        }
+        int r = row + offset.dr;
+        int c = col + offset.dc;
+        if (r < 0 || r >= rows || c < 0 || c >= cols || (r == row && c == col))
+            continue;
+        radar_results.emplace_back(types[rng() % 5], r, c);
+    }
+}
 
-        // Call get_radar_direction and simulate radar scanning
-        robot->get_radar_direction(radar_direction);
-        std::cout << "Radar direction chosen: " << radar_direction << std::endl;
+// Drives fresh robots through random boards ("episodes") until the turn budget is used.
+// Every output is checked against what the arena accepts.
+// As in the arena, a robot that exports get_turn_planner decides each turn in
+// one plan_turn call, and otherwise one that exports get_radar_beam_receiver
+// gets its radar as a RadarBeam.
+void stress_robot(RobotFactory create_robot, TurnPlannerLookup get_planner, RadarBeamReceiverLookup get_beam_receiver,
+                  const HarnessOptions& options, CallStats (&stats)[call_count], Violations& violations)
+{
+    std::mt19937_64 rng(options.seed);
+    std::vector<RadarObj> radar_results;
+    radar_results.reserve(8);
+    RadarBeamPacker packer;
+
+    uint64_t turn = 0;
+    uint64_t episodes = 0;
+    while (turn < options.turns)
+    {
+        int span = options.max_board - options.min_board + 1;
+        int rows = options.min_board + rng() % span;
+        int cols = options.min_board + rng() % span;
+        uint64_t episode_turns = 50 + rng() % 2000;
 
-        if (turn == 2) {
-            // Simulate detecting an enemy on turn 2
-            RadarObj enemy('R', 10, 11);
-            radar_results.push_back(enemy);
+        RobotBase* robot = create_robot();
+        if (!robot)
+        {
+            std::cerr << "create_robot returned null\n";
+            violations.count++;
+            return;
         }
+        robot->set_boundaries(rows, cols);
+        robot->move_to(rng() % rows, rng() % cols);
+        TurnPlanner* planner = get_planner ? get_planner(robot) : nullptr;
+        RadarBeamReceiver* beam_receiver = get_beam_receiver ? get_beam_receiver(robot) : nullptr;
+        episodes++;
 
-        // Pass radar results to the robot
-        robot->process_radar_results(radar_results);
-
-        int shot_row = 0, shot_col = 0;
-        if (robot->get_shot_location(shot_row, shot_col)) {
-            std::cout << "Robot shoots at (" << shot_row << ", " << shot_col << ").\n";
-            if (!radar_results.empty()) {
-                const auto& enemy = radar_results[0];
-                if (shot_row == enemy.m_row && shot_col == enemy.m_col) {
-                    std::cout << "Shot location matches radar target: (" << enemy.m_row << ", " << enemy.m_col << ").\n";
-                } else {
-                    std::cerr << "Error: Shot location (" << shot_row << ", " << shot_col
-                              << ") does not match radar target (" << enemy.m_row << ", " << enemy.m_col << ").\n";
-                }
+        for (uint64_t t = 0; t < episode_turns && turn < options.turns && robot->get_health() > 0; t++, turn++)
+        {
+            int row, col;
+            robot->get_current_location(row, col);
+
+            int radar_direction = -1;
+            timed(stats[call_radar], [&] { robot->get_radar_direction(radar_direction); });
+            if (radar_direction < 0 || radar_direction > 8)
+            {
+                violations.report(turn, rows, cols, "radar direction " + std::to_string(radar_direction));
+                radar_direction = 0;
             }
-            took_action = true;
-        } else {
-            std::cout << "No shooting this turn.\n";
-        }
-
-        // Simulate movement
-        int move_direction = 0, move_distance = 0;
-        robot->get_move_direction(move_direction, move_distance);
 
-        if (move_direction != 0 && move_distance != 0) 
-        {
-            // Predefined directional increments for movement (1-8, clock directions) come from RobotBase
-            int delta_row = directions[move_direction].first;
-            int delta_col = directions[move_direction].second;
-
-            // Calculate new position
-            int current_row, current_col;
-            robot->get_current_location(current_row, current_col);
-            int target_row = std::clamp(current_row + delta_row * move_distance, 0, 19);
-            int target_col = std::clamp(current_col + delta_col * move_distance, 0, 19);
-
-            // Move the robot
-            robot->move_to(target_row, target_col);
-
-            std::cout << "Robot moves to (" << target_row << ", " << target_col << ").\n";
-
-            // Verify the movement
-            int verify_row, verify_col;
-            robot->get_current_location(verify_row, verify_col);
-            if (verify_row == target_row && verify_col == target_col) {
-                std::cout << "Movement verified!\n";
-            } else {
-                std::cerr << "Error: Robot did not move to the expected location!\n";
+            random_radar(rng, rows, cols, row, col, radar_direction, radar_results);
+            int shot_row = -1, shot_col = -1;
+            int move_direction = -1, move_distance = -1;
+            bool shooting;
+            if (planner)
+            {
+                TurnPlan plan = timed(stats[call_process], [&] { return planner->plan_turn(radar_results); });
+                shooting = plan.shoot;
+                shot_row = plan.shot_row;
+                shot_col = plan.shot_col;
+                move_direction = plan.move_direction;
+                move_distance = plan.move_distance;
+            }
+            else
+            {
+                if (beam_receiver)
+                {
+                    const RadarBeam& beam = packer.pack(rows, cols, row, col, radar_direction, radar_results);
+                    timed(stats[call_process], [&] { beam_receiver->process_radar_beam(beam); });
+                }
+                else
+                {
+                    timed(stats[call_process], [&] { robot->process_radar_results(radar_results); });
+                }
+                shooting = timed(stats[call_shot], [&] { return robot->get_shot_location(shot_row, shot_col); });
+                if (!shooting)
+                    timed(stats[call_move], [&] { robot->get_move_direction(move_direction, move_distance); });
             }
 
-            took_action = true;
-        } else {
-            std::cout << "Robot chooses not to move.\n";
-        }
+            if (shooting)
+            {
+                if (shot_row < 0 || shot_row >= rows || shot_col < 0 || shot_col >= cols)
+                {
+                    violations.report(turn, rows, cols, "shot at (" + std::to_string(shot_row) + ","
+                                      + std::to_string(shot_col) + ")");
+                }
+                if (robot->get_weapon() == grenade)
+                    robot->decrement_grenades();
+            }
+            else
+            {
+                if (move_direction < 0 || move_direction > 8)
+                {
+                    violations.report(turn, rows, cols, "move direction " + std::to_string(move_direction));
+                }
+                else if (move_distance < 0)
+                {
+                    violations.report(turn, rows, cols, "move distance " + std::to_string(move_distance));
+                }
+                else
+                {
+                    if (move_distance > robot->get_move_speed())
+                        violations.over_speed++;
+
+                    // Move the way the arena does: capped at the robot's speed and stopping at the edge
+                    int steps = std::min(move_distance, robot->get_move_speed());
+                    auto [dr, dc] = directions[move_direction];
+                    for (int s = 0; s < steps; s++)
+                    {
+                        if (row + dr < 0 || row + dr >= rows || col + dc < 0 || col + dc >= cols)
+                            break;
+                        row += dr;
+                        col += dc;
+                    }
+                    robot->move_to(row, col);
+                }
+            }
 
-        // Check for inactivity
-        if (took_action) {
-            inactive_turns = 0; // Reset inactivity counter
-        } else {
-            ++inactive_turns;
-            if (inactive_turns >= 5) {
-                std::cerr << "Warning: Robot has not moved or shot for " << inactive_turns << " consecutive turns.\n";
+            // Now and then let the rest of the arena happen to the robot
+            uint64_t event = rng() % 1000;
+            if (event < 10)
+            {
+                robot->take_damage(10 + rng() % 30);
+                robot->reduce_armor(1);
+            }
+            else if (event == 10)
+            {
+                robot->disable_movement();   // fell in a pit
+            }
+            else if (event == 11)
+            {
+                robot->move_to(rng() % rows, rng() % cols);
             }
         }
+
+        delete robot;
     }
+
+    std::cout << "Ran " << turn << " turns over " << episodes << " boards between "
+              << options.min_board << "x" << options.min_board << " and "
+              << options.max_board << "x" << options.max_board << ".\n";
 }
 
+bool print_report(const CallStats (&stats)[call_count], const Violations& violations,
+                  const HarnessOptions& options)
+{
+    bool passed = violations.count == 0;
+
+    std::cout << '\n' << std::left << std::setw(24) << "call" << std::right
+              << std::setw(12) << "calls" << std::setw(11) << "mean ns" << std::setw(11) << "p50 ns"
+              << std::setw(11) << "p99 ns" << std::setw(12) << "max ns" << std::setw(14) << "allocs/call"
+              << std::setw(14) << "bytes/call" << '\n';
+    for (int c = 0; c < call_count; c++)
+    {
+        const CallStats& s = stats[c];
+        if (c != call_radar && s.calls == 0)
+            continue;   // a planner's shot and move are part of plan_turn
+        double calls = s.calls ? double(s.calls) : 1.0;
+        std::cout << std::left << std::setw(24) << call_names[c] << std::right
+                  << std::setw(12) << s.calls
+                  << std::setw(11) << uint64_t(s.total_ns / calls)
+                  << std::setw(11) << s.percentile_ns(50)
+                  << std::setw(11) << s.percentile_ns(99)
+                  << std::setw(12) << s.max_ns
+                  << std::setw(14) << std::fixed << std::setprecision(3) << s.allocations / calls
+                  << std::setw(14) << std::setprecision(1) << s.allocated_bytes / calls << '\n';
+
+        if (options.max_p99_us > 0 && s.percentile_ns(99) > options.max_p99_us * 1000)
+        {
+            std::cerr << "Too slow: " << call_names[c] << " p99 is over " << options.max_p99_us << " us\n";
+            passed = false;
+        }
+    }
 
+    std::cout << "\nViolations: " << violations.count << '\n';
+    if (violations.over_speed)
+    {
+        std::cout << "Move requests over the robot's speed (the arena caps these): "
+                  << violations.over_speed << '\n';
+    }
+    return passed;
+}
 
-int main(int argc, char* argv[]) 
+int main(int argc, char* argv[])
 {
     //argv[1] should contain the name of the Robot_.cpp file to load.
 
-    if (argc != 2) 
+    if (argc < 2)
     {
-        std::cerr << "Usage: " << argv[0] << " <robot_library>\n";
+        std::cerr << "Usage: " << argv[0] << " <Robot_file.cpp> [--turns N] [--seed S]"
+                  << " [--min-board N] [--max-board N] [--max-p99-us US]\n";
         return 1;
     }
 
+    HarnessOptions options;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        std::string flag = argv[i];
+        std::string value = argv[i + 1];
+        if (flag == "--turns") options.turns = std::stoull(value);
+        else if (flag == "--seed") options.seed = std::stoull(value);
+        else if (flag == "--min-board") options.min_board = std::max(10, std::stoi(value));
+        else if (flag == "--max-board") options.max_board = std::stoi(value);
+        else if (flag == "--max-p99-us") options.max_p99_us = std::stod(value);
+        else
+        {
+            std::cerr << "Unknown option " << flag << '\n';
+            return 1;
+        }
+    }
+    options.max_board = std::max(options.max_board, options.min_board);
+
     const std::string robot_file = argv[1];
-    const std::string shared_lib = "lib" + robot_file.substr(0, robot_file.find(".cpp")) + ".so";
+    const std::string shared_lib = "./lib" + robot_file.substr(0, robot_file.find(".cpp")) + ".so";
 
     // Compile the robot into a shared library -fPIC is Position Independant Code - look it up!
     // we're also linking a pre-compiled RobotBase.o - problems will arise if there is a mismatch...
@@ -166,17 +410,33 @@ int main(int argc, char* argv[])
 
     std::cout << "Success!" << std::endl;
 
-    RobotBase *robot;
     void *handle;
+    RobotFactory create_robot = load_robot_factory(shared_lib, handle);
+    if (!create_robot)
+        return 1;
+
+    auto get_planner = (TurnPlannerLookup)dlsym(handle, "get_turn_planner");
+    auto get_beam_receiver = (RadarBeamReceiverLookup)dlsym(handle, "get_radar_beam_receiver");
+    if (get_planner)
+    {
+        call_names[call_process] = "plan_turn";
+        std::cout << "The robot plans each turn in one call (RobotPlanner.h).\n";
+    }
+    else if (get_beam_receiver)
+    {
+        call_names[call_process] = "process_radar_beam";
+        std::cout << "The robot takes its radar as bitmasks (RobotRadar.h).\n";
+    }
 
-    robot = load_robot(shared_lib, handle);
-    test_robot_behavior(robot);
+    CallStats stats[call_count];
+    Violations violations;
+    stress_robot(create_robot, get_planner, get_beam_receiver, options, stats, violations);
+    bool passed = print_report(stats, violations, options);
 
     // Cleanup
-    delete robot;
     dlclose(handle);
 
-    std::cout << "Robot testing complete.\n";
+    std::cout << (passed ? "Robot passed.\n" : "Robot FAILED.\n");
 
-    return 0;
+    return passed ? 0 : 1;
 }